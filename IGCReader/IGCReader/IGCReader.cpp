@@ -5,7 +5,21 @@
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <random>
 
 
 /**
@@ -40,6 +54,7 @@ public:
 	IGCFile() = default;
 	~IGCFile() = default;
 	bool read(const char* datafile, FlightRecord& FlightRecord);
+	void parse(std::string& text, FlightRecord& flightRecord);
 };
 
 class Split {
@@ -52,6 +67,108 @@ public:
 	bool m_found{ false };
 };
 
+/*
+IGC field layouts
+
+Most IGC records are fixed width. Each field is described by a template with its offset (from the
+record type character), width and the characters allowed. A RecordLayout lists the fields of a
+record, so the length check and the validation of every field are generated at compile time
+and the loops over the constant widths are unrolled by the compiler.
+
+	DigitsField<Offset, Width, Max>		0-9, optionally not more than Max
+	SignedField<Offset, Width>			0-9, negative values have a leading '-' instead of a leading zero
+	AlphanumericField<Offset, Width>	A-Z, a-z, 0-9
+	ChoiceField<Offset, Choices...>		One character of the list, e.g. N or S
+	TimeField<Offset>					HHMMSS, value in seconds since midnight
+*/
+template <int Offset, int Width, int Max = -1>
+struct DigitsField {
+	static constexpr int Begin = Offset;
+	static constexpr int End = Offset + Width;
+	static bool isValid(const char* text) {
+		unsigned bad = 0;
+		for (int i = Offset; i < End; i++) {
+			bad |= (unsigned)(text[i] - '0') > 9;
+		}
+		return bad == 0 && (Max < 0 || value(text) <= Max);
+	}
+	static int value(const char* text) {
+		int result = 0;
+		for (int i = Offset; i < End; i++) {
+			result = (result * 10) + (text[i] - '0');
+		}
+		return result;
+	}
+};
+
+template <int Offset, int Width>
+struct SignedField {
+	static constexpr int Begin = Offset;
+	static constexpr int End = Offset + Width;
+	static bool isValid(const char* text) {
+		unsigned bad = (text[Offset] != '-') & ((unsigned)(text[Offset] - '0') > 9);
+		for (int i = Offset + 1; i < End; i++) {
+			bad |= (unsigned)(text[i] - '0') > 9;
+		}
+		return bad == 0;
+	}
+	static int value(const char* text) {
+		int result = 0;
+		for (int i = Offset + (text[Offset] == '-'); i < End; i++) {
+			result = (result * 10) + (text[i] - '0');
+		}
+		return (text[Offset] == '-') ? -result : result;
+	}
+};
+
+template <int Offset, int Width>
+struct AlphanumericField {
+	static constexpr int Begin = Offset;
+	static constexpr int End = Offset + Width;
+	static bool isValid(const char* text) {
+		bool valid = true;
+		for (int i = Offset; i < End; i++) {
+			valid &= (isalnum((unsigned char)text[i]) != 0);
+		}
+		return valid;
+	}
+	static std::string value(const char* text) {
+		return std::string(text + Offset, Width);
+	}
+};
+
+template <int Offset, char... Choices>
+struct ChoiceField {
+	static constexpr int Begin = Offset;
+	static constexpr int End = Offset + 1;
+	static bool isValid(const char* text) {
+		return ((text[Offset] == Choices) || ...);
+	}
+	static char value(const char* text) {
+		return text[Offset];
+	}
+};
+
+template <int Offset>
+struct TimeField {
+	static constexpr int Begin = Offset;
+	static constexpr int End = Offset + 6;
+	static bool isValid(const char* text) {
+		return DigitsField<Offset, 2, 23>::isValid(text) & DigitsField<Offset + 2, 2, 59>::isValid(text) & DigitsField<Offset + 4, 2, 59>::isValid(text);
+	}
+	static int value(const char* text) {
+		return (DigitsField<Offset, 2>::value(text) * 3600) + (DigitsField<Offset + 2, 2>::value(text) * 60) + DigitsField<Offset + 4, 2>::value(text);
+	}
+};
+
+template <typename... Fields>
+struct RecordLayout {
+	static constexpr int Length = std::max({ Fields::End... });
+	static bool isValid(const char* text, size_t length) {
+		return length >= (size_t)Length && (Fields::isValid(text) & ...);
+	}
+};
+
 
 bool Utils::FileExists(const char* p)
 {
@@ -83,63 +200,65 @@ Split::Split(const char* s)
 }
 
 class A_Record {// - FR manufacturer and identification(always first)
-	static std::string m_manufacturer;		// Manufacturer	3 bytes	MMM	Alphanumeric, see para 2.5.6
-	static std::string m_uniqueID;			// Unique ID		3 bytes	NNN	Valid characters alphanumeric(AL3)
-	static std::string m_idExtension;		// ID extension	Optional	TEXT STRING	Valid characters alphanumeric
+	std::string m_manufacturer;		// Manufacturer	3 bytes	MMM	Alphanumeric, see para 2.5.6
+	std::string m_uniqueID;			// Unique ID		3 bytes	NNN	Valid characters alphanumeric(AL3)
+	std::string m_idExtension;		// ID extension	Optional	TEXT STRING	Valid characters alphanumeric
 public:
 	A_Record() = default;
 	~A_Record() = default;
 	void parse(const char* text);
-	static std::string getManufacturer() { return m_manufacturer; };
-	static std::string getUniqueID() { return m_uniqueID; };
-	static std::string getIDExtension() { return m_idExtension; };
+	std::string getManufacturer() const { return m_manufacturer; };
+	std::string getUniqueID() const { return m_uniqueID; };
+	std::string getIDExtension() const { return m_idExtension; };
 	void print();
 };
 
 class H_Record {// - File header
-	static std::string m_utcDate; // UTC date this file was recorded
-	static std::string m_accuracy; // Fix accuracy in meters, see also FXA three - letter - code reference
-	static std::string m_pilot;
-	static std::string m_copilot;
-	static std::string m_gliderModel;
-	static std::string m_gliderRegistration;
-	static std::string m_gpsDatum;
-	static std::string m_firmwareRevision;
-	static std::string m_hardwareRevision;
-	static std::string m_manufacturerAndModel;
-	static std::string m_gpsManufacturerAndModel;
-	static std::string m_pressureSensor;
-	static std::string m_gliderCompID;
-	static std::string m_gliderCompClass;
-	static std::string m_downloadSoftware;
-	static std::string m_gnssAltitude;
-	static std::string m_pressureMode;
-	static std::string m_timeZone;
+	std::string m_utcDate; // UTC date this file was recorded
+	std::string m_accuracy; // Fix accuracy in meters, see also FXA three - letter - code reference
+	std::string m_pilot;
+	std::string m_copilot;
+	std::string m_gliderModel;
+	std::string m_gliderRegistration;
+	std::string m_gpsDatum;
+	std::string m_firmwareRevision;
+	std::string m_hardwareRevision;
+	std::string m_manufacturerAndModel;
+	std::string m_gpsManufacturerAndModel;
+	std::string m_pressureSensor;
+	std::string m_gliderCompID;
+	std::string m_gliderCompClass;
+	std::string m_downloadSoftware;
+	std::string m_gnssAltitude;
+	std::string m_pressureMode;
+	std::string m_timeZone;
 
 	
 public:
 	H_Record() = default;;
 	~H_Record() = default;
 	void parse(const char* text);
-	static std::string getUTCDate() { return m_utcDate; };
-	static std::string getAccuracy() { return m_accuracy; };
-	static std::string getPilot() { return m_pilot; };
-	static std::string getCopilot() { return m_copilot; };
-	static std::string getGliderModel() { return m_gliderModel; };
-	static std::string getGliderRegistration() { return m_gliderRegistration; };
-	static std::string getGPSDatum() { return m_gpsDatum; };
-	static std::string getFirmwareRevision() { return m_firmwareRevision; };
-	static std::string getHardwareRevision() { return m_hardwareRevision; };
-	static std::string getManufacturerAndModel() { return m_manufacturerAndModel; };
-	static std::string getGPSManufacturerAndModel() { return m_gpsManufacturerAndModel; };
-	static std::string getPressureSensor() { return m_pressureSensor; };
-	static std::string getGliderCompID() { return m_gliderCompID; };
-	static std::string getGliderCompClass() { return m_gliderCompClass; };
-	static std::string getDownloadSoftware() { return m_downloadSoftware; };
-	static std::string getGNSSAltitude() { return m_gnssAltitude; };
-	static std::string getPressureMode() { return m_pressureMode; };
-	static std::string getTimeZone() { return m_timeZone; };
+	std::string getUTCDate() const { return m_utcDate; };
+	uint32_t getDate() const { return parseDate(m_utcDate); };
+	std::string getAccuracy() const { return m_accuracy; };
+	std::string getPilot() const { return m_pilot; };
+	std::string getCopilot() const { return m_copilot; };
+	std::string getGliderModel() const { return m_gliderModel; };
+	std::string getGliderRegistration() const { return m_gliderRegistration; };
+	std::string getGPSDatum() const { return m_gpsDatum; };
+	std::string getFirmwareRevision() const { return m_firmwareRevision; };
+	std::string getHardwareRevision() const { return m_hardwareRevision; };
+	std::string getManufacturerAndModel() const { return m_manufacturerAndModel; };
+	std::string getGPSManufacturerAndModel() const { return m_gpsManufacturerAndModel; };
+	std::string getPressureSensor() const { return m_pressureSensor; };
+	std::string getGliderCompID() const { return m_gliderCompID; };
+	std::string getGliderCompClass() const { return m_gliderCompClass; };
+	std::string getDownloadSoftware() const { return m_downloadSoftware; };
+	std::string getGNSSAltitude() const { return m_gnssAltitude; };
+	std::string getPressureMode() const { return m_pressureMode; };
+	std::string getTimeZone() const { return m_timeZone; };
 	void print();
+	static uint32_t parseDate(const std::string& text);
 };
 /*
 I record
@@ -150,18 +269,29 @@ Finish byte number		2 bytes	FF		Valid characters 0-9
 3-letter Code			3 bytes	CCC		Alphanumeric, see para 7 for list of codes
 
 */
+struct FixExtension {
+	int m_start{ 0 };	// Start byte number		2 bytes	SS		Valid characters 0 - 9
+	int m_finish{ 0 };	// Finish byte number		2 bytes	FF		Valid characters 0 - 9
+	std::string m_code;	// 3-letter Code			3 bytes	CCC		Alphanumeric, see para 7 for list of codes
+};
+
 class I_Record { // - Fix extension list, of data added at end of each B record
-	std::string m_number;			// Number of extensions		2 bytes	NN		Valid characters 0 - 9
-	std::string m_startByteNumber;	// Start byte number		2 bytes	SS		Valid characters 0 - 9
-	std::string m_finishByteNumber;	// Finish byte number		2 bytes	FF		Valid characters 0 - 9
-	std::string m_code;				// 3-letter Code			3 bytes	CCC		Alphanumeric, see para 7 for list of codes
+	typedef DigitsField<1, 2> Number;				// Number of extensions		2 bytes	NN		Valid characters 0 - 9
+	typedef DigitsField<0, 2> StartByteNumber;		// Relative to each extension
+	typedef DigitsField<2, 2> FinishByteNumber;
+	typedef AlphanumericField<4, 3> Code;
+	typedef RecordLayout<Number> Layout;
+	typedef RecordLayout<StartByteNumber, FinishByteNumber, Code> ExtensionLayout;
+	static const int ExtensionSize = 7;
+
+	std::vector<FixExtension> m_extensions;
+	bool m_valid{ false };
 public:
 	I_Record(const char* text);
 	I_Record() = default;
-	std::string getNumber() { return m_number; };
-	std::string getStartByteNumber() { return m_startByteNumber; };
-	std::string getFinishByteNumber() { return m_finishByteNumber; };
-	std::string getCode() { return m_code; };
+	bool isValid() const { return m_valid; };
+	int getNumber() const { return (int)m_extensions.size(); };
+	const std::vector<FixExtension>& getExtensions() const { return m_extensions; };
 };
 
 class J_Record { // - Extension list of data in each K record line
@@ -183,47 +313,117 @@ public:
 };
 
 class D_Record { // - Differential GPS(if used)
+	// D Q SSSS
+	typedef ChoiceField<1, '1', '2'> Qualifier;		// 1 = GPS, 2 = DGPS
+	typedef DigitsField<2, 4> StationID;			// DGPS station ID
+	typedef RecordLayout<Qualifier, StationID> Layout;
+
+	char m_qualifier{ '1' };
+	int m_stationID{ 0 };
+	bool m_valid{ false };
 public:
 	D_Record(const char* text);
 	~D_Record() = default;
+	bool isValid() const { return m_valid; };
+	bool isDGPS() const { return m_qualifier == '2'; };
+	int getStationID() const { return m_stationID; };
 };
 
 class F_Record { // - Initial Satellite Constellation
+	// F HHMMSS AABBCC...
+	typedef TimeField<1> Time;
+	typedef RecordLayout<Time> Layout;
+	typedef DigitsField<0, 2> Satellite;	// Relative to each satellite
+	static const int SatelliteStart = 7;
+
+	int m_time{ 0 };
+	std::vector<int> m_satellites;
+	bool m_valid{ false };
 public:
 	F_Record(const char* text);
 	~F_Record() = default;
+	bool isValid() const { return m_valid; };
+	int getTimeSeconds() const { return m_time; };
+	const std::vector<int>& getSatellites() const { return m_satellites; };
 };
 
 class B_Record { // - Fix plus any extension data listed in I Record
-	std::string m_timeUTC;
-	std::string m_latitude;
-	std::string m_longitude;
-	std::string m_fixValidity;
-	std::string m_pressAlt;
-	std::string m_gnssAlt;
+	// B HHMMSS DDMMmmmN DDDMMmmmE V PPPPP GGGGG
+	typedef TimeField<1> Time;
+	typedef DigitsField<7, 2, 90> LatDegrees;
+	typedef DigitsField<9, 5, 59999> LatMinutes;		// Thousandths of minutes
+	typedef ChoiceField<14, 'N', 'S'> LatHemisphere;
+	typedef DigitsField<15, 3, 180> LongDegrees;
+	typedef DigitsField<18, 5, 59999> LongMinutes;		// Thousandths of minutes
+	typedef ChoiceField<23, 'E', 'W'> LongHemisphere;
+	typedef ChoiceField<24, 'A', 'V'> FixValidity;
+	typedef SignedField<25, 5> PressAlt;
+	typedef SignedField<30, 5> GNSSAlt;
+	typedef RecordLayout<Time, LatDegrees, LatMinutes, LatHemisphere, LongDegrees, LongMinutes, LongHemisphere,
+		FixValidity, PressAlt, GNSSAlt> Layout;
+
+	int m_time{ 0 };			// Seconds since midnight UTC
+	int m_lat{ 0 };				// Thousandths of minutes, south negative
+	int m_long{ 0 };			// Thousandths of minutes, west negative
+	char m_fixValidity{ 'V' };
+	int m_pressAlt{ 0 };
+	int m_gnssAlt{ 0 };
+	bool m_valid{ false };
+
+	static std::string format(const char* format, int a, int b, int c);
 public:
 	B_Record(const char* text);
+	B_Record(const char* text, size_t length);
 	B_Record() = default;
-	std::string getTimeUTC() { return m_timeUTC; };
-	std::string getLatitude() { return m_latitude; };
-	std::string getLongitude() { return m_longitude; };
-	std::string getFixValidity() { return m_fixValidity; };
-	std::string getPressAlt() { return m_pressAlt; };
-	std::string getGNSSAlt() { return m_gnssAlt; };
+	bool isValid() const { return m_valid; };
+	std::string getTimeUTC() const { return format("%02d%02d%02d", m_time / 3600, (m_time / 60) % 60, m_time % 60); };
+	std::string getLatitude() const { return format("%02d%05d%c", std::abs(m_lat) / 60000, std::abs(m_lat) % 60000, (m_lat < 0) ? 'S' : 'N'); };
+	std::string getLongitude() const { return format("%03d%05d%c", std::abs(m_long) / 60000, std::abs(m_long) % 60000, (m_long < 0) ? 'W' : 'E'); };
+	std::string getFixValidity() const { return std::string(1, m_fixValidity); };
+	std::string getPressAlt() const { return format("%05d", m_pressAlt, 0, 0); };
+	std::string getGNSSAlt() const { return format("%05d", m_gnssAlt, 0, 0); };
+	int getTimeSeconds() const { return m_time; };
+	double getLatitudeDegrees() const { return m_lat / 60000.0; };		// Decimal degrees, south negative
+	double getLongitudeDegrees() const { return m_long / 60000.0; };	// Decimal degrees, west negative
+	int getPressAltMeters() const { return m_pressAlt; };
+	int getGNSSAltMeters() const { return m_gnssAlt; };
 
 	void print();
 };
 
 class E_Record { // - Pilot Event(PEV)
+	// E HHMMSS CCC TEXT
+	typedef TimeField<1> Time;
+	typedef AlphanumericField<7, 3> Code;	// 3-letter code, e.g. PEV
+	typedef RecordLayout<Time, Code> Layout;
+
+	int m_time{ 0 };
+	std::string m_code;
+	std::string m_text;
+	bool m_valid{ false };
 public:
 	E_Record(const char* text);
 	~E_Record() = default;
+	bool isValid() const { return m_valid; };
+	int getTimeSeconds() const { return m_time; };
+	std::string getCode() const { return m_code; };
+	std::string getText() const { return m_text; };
 };
 
 class K_Record { // - Extension data as defined in J Record
+	// K HHMMSS DATA
+	typedef TimeField<1> Time;
+	typedef RecordLayout<Time> Layout;
+
+	int m_time{ 0 };
+	std::string m_data;		// Fields as listed in the J record
+	bool m_valid{ false };
 public:
 	K_Record(const char* text);
 	~K_Record() = default;
+	bool isValid() const { return m_valid; };
+	int getTimeSeconds() const { return m_time; };
+	std::string getData() const { return m_data; };
 };
 
 class G_Record { // - Security record(always last)
@@ -238,22 +438,21 @@ Unique ID		3 bytes	NNN	Valid characters alphanumeric(AL3)
 ID extension	Optional	TEXT STRING	Valid characters alphanumeric
 */
 
-std::string A_Record::m_manufacturer;		// Manufacturer	3 bytes	MMM	Alphanumeric, see para 2.5.6
-std::string A_Record::m_uniqueID;			// Unique ID		3 bytes	NNN	Valid characters alphanumeric(AL3)
-std::string A_Record::m_idExtension;		// ID extension	Optional	TEXT STRING	Valid characters alphanumeric
 
 void A_Record::parse(const char* text) {
-	std::string rec = text;
-	std::string type = rec.substr(1, 3);
-	if (type.compare("MMM") == 0) {// Manufacturer
-		m_manufacturer = rec.substr(4, rec.length() - 4);
-		return;
-	}
-	if (type.compare("NNN") == 0) {// Unique ID
-		m_uniqueID = rec.substr(4, rec.length() - 4);
+	// A MMM NNN TEXT
+	typedef AlphanumericField<1, 3> Manufacturer;
+	typedef AlphanumericField<4, 3> UniqueID;
+	typedef RecordLayout<Manufacturer, UniqueID> Layout;
+
+	size_t length = strlen(text);
+	if (Layout::isValid(text, length) == false) {
+		m_idExtension = (length > 1) ? std::string(text + 1) : "";
 		return;
 	}
-	m_idExtension = rec.substr(1, rec.length() - 2);
+	m_manufacturer = Manufacturer::value(text);
+	m_uniqueID = UniqueID::value(text);
+	m_idExtension = std::string(text + Layout::Length);
 }
 
 void A_Record::print() {
@@ -319,24 +518,6 @@ void A_Record::print() {
 	*/
 
 
-std::string H_Record::m_utcDate; // UTC date this file was recorded
-std::string H_Record::m_accuracy; // Fix accuracy in meters, see also FXA three - letter - code reference
-std::string H_Record::m_pilot;
-std::string H_Record::m_copilot;
-std::string H_Record::m_gliderModel;
-std::string H_Record::m_gliderRegistration;
-std::string H_Record::m_gpsDatum;
-std::string H_Record::m_firmwareRevision;
-std::string H_Record::m_hardwareRevision;
-std::string H_Record::m_manufacturerAndModel;
-std::string H_Record::m_gpsManufacturerAndModel;
-std::string H_Record::m_pressureSensor;
-std::string H_Record::m_gliderCompID;
-std::string H_Record::m_gliderCompClass;
-std::string H_Record::m_downloadSoftware;
-std::string H_Record::m_gnssAltitude;
-std::string H_Record::m_pressureMode;
-std::string H_Record::m_timeZone;
 
 void H_Record::parse(const char* text) {
 	std::string rec = text;
@@ -442,8 +623,47 @@ void H_Record::print()
 	if (getTimeZone().length() != 0) { printf("Time Zone: %s\n", getTimeZone().c_str()); }
 }
 
-I_Record::I_Record(const char* text) {
+// HFDTE date, DDMMYY alone or after DATE:, as YYYYMMDD. Returns 0 if there is no date.
+uint32_t H_Record::parseDate(const std::string& text)
+{
+	typedef DigitsField<0, 2, 31> Day;
+	typedef DigitsField<2, 2, 12> Month;
+	typedef DigitsField<4, 2> Year;
+	typedef RecordLayout<Day, Month, Year> Layout;
+	for (size_t i = 0; i + Layout::Length <= text.length(); i++) {
+		const char* date = text.c_str() + i;
+		if (Layout::isValid(date, text.length() - i)) {
+			uint32_t year = Year::value(date);
+			year += (year < 80) ? 2000 : 1900;
+			return (year * 10000) + (Month::value(date) * 100) + Day::value(date);
+		}
+	}
+	return 0;
+}
 
+I_Record::I_Record(const char* text) {
+	size_t length = strlen(text);
+	if (Layout::isValid(text, length) == false) {
+		return;
+	}
+	int number = Number::value(text);
+	if (length < (size_t)(Layout::Length + number * ExtensionSize)) {
+		return;
+	}
+	m_extensions.reserve(number);
+	for (int i = 0; i < number; i++) {
+		const char* extension = text + Layout::Length + (i * ExtensionSize);
+		if (ExtensionLayout::isValid(extension, ExtensionSize) == false) {
+			m_extensions.clear();
+			return;
+		}
+		FixExtension fixExtension;
+		fixExtension.m_start = StartByteNumber::value(extension);
+		fixExtension.m_finish = FinishByteNumber::value(extension);
+		fixExtension.m_code = Code::value(extension);
+		m_extensions.push_back(fixExtension);
+	}
+	m_valid = true;
 }
 
 J_Record::J_Record(const char* text) {
@@ -459,11 +679,27 @@ L_Record::L_Record(const char* text) {
 }
 
 D_Record::D_Record(const char* text) {
-
+	if (Layout::isValid(text, strlen(text)) == false) {
+		return;
+	}
+	m_qualifier = Qualifier::value(text);
+	m_stationID = StationID::value(text);
+	m_valid = true;
 }
 
 F_Record::F_Record(const char* text) {
-
+	size_t length = strlen(text);
+	if (Layout::isValid(text, length) == false) {
+		return;
+	}
+	m_time = Time::value(text);
+	for (size_t i = SatelliteStart; i + 2 <= length; i += 2) {
+		if (Satellite::isValid(text + i) == false) {
+			break;
+		}
+		m_satellites.push_back(Satellite::value(text + i));
+	}
+	m_valid = true;
 }
 /*
 *
@@ -491,28 +727,34 @@ GNSS Alt.				5 bytes	GGGGG		Altitude above the WGS84 ellipsoid, valid characters
 
 
 
-B_Record::B_Record(const char* s) {
-	// B 124650 5052990N 00013032W A 00199 00189
-	std::string text = s;
-	text = text.substr(1, text.length() - 1);
-
-	m_timeUTC = text.substr(0, 6);
-	text = text.substr(6, text.length() - 1);
-
-	m_latitude = text.substr(0, 8);
-	text = text.substr(8, text.length() - 1);
-
-	m_longitude = text.substr(0, 9);
-	text = text.substr(9, text.length() - 1);
-
-	m_fixValidity = text.substr(0, 1);
-	text = text.substr(1, text.length() - 1);
+B_Record::B_Record(const char* text) : B_Record(text, strlen(text)) {
+}
 
-	m_pressAlt = text.substr(0, 5);
-	text = text.substr(5, text.length() - 1);
+B_Record::B_Record(const char* text, size_t length) {
+	// B 124650 5052990N 00013032W A 00199 00189
+	if (Layout::isValid(text, length) == false) {
+		return;
+	}
+	m_time = Time::value(text);
+	m_lat = (LatDegrees::value(text) * 60000) + LatMinutes::value(text);
+	if (LatHemisphere::value(text) == 'S') {
+		m_lat = -m_lat;
+	}
+	m_long = (LongDegrees::value(text) * 60000) + LongMinutes::value(text);
+	if (LongHemisphere::value(text) == 'W') {
+		m_long = -m_long;
+	}
+	m_fixValidity = FixValidity::value(text);
+	m_pressAlt = PressAlt::value(text);
+	m_gnssAlt = GNSSAlt::value(text);
+	m_valid = true;
+}
 
-	m_gnssAlt = text.substr(0, 5);
-	text = text.substr(5, text.length() - 1);
+std::string B_Record::format(const char* format, int a, int b, int c)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), format, a, b, c);
+	return buffer;
 }
 
 static std::vector <std::shared_ptr<B_Record>> s_BRecords{ nullptr };
@@ -528,11 +770,23 @@ void B_Record::print()
 }
 
 E_Record::E_Record(const char* text) {
-
+	size_t length = strlen(text);
+	if (Layout::isValid(text, length) == false) {
+		return;
+	}
+	m_time = Time::value(text);
+	m_code = Code::value(text);
+	m_text = std::string(text + Layout::Length);
+	m_valid = true;
 }
 
 K_Record::K_Record(const char* text) {
-
+	if (Layout::isValid(text, strlen(text)) == false) {
+		return;
+	}
+	m_time = Time::value(text);
+	m_data = std::string(text + Layout::Length);
+	m_valid = true;
 }
 
 G_Record::G_Record(const char* text) {
@@ -551,6 +805,7 @@ class FlightRecord {
 	*/
 	std::shared_ptr<A_Record> m_aRecord{ nullptr };
 	std::shared_ptr<H_Record> m_hRecord{ nullptr };
+	std::shared_ptr<I_Record> m_iRecord{ nullptr };
 	/*
 	MULTIPLE INSTANCE DATA RECORDS
 	B record - Fix
@@ -561,6 +816,10 @@ class FlightRecord {
 	D record - Differential GPS
 	*/
 	std::vector<std::shared_ptr<B_Record>> m_bRecords;
+	std::vector<std::shared_ptr<E_Record>> m_eRecords;
+	std::vector<std::shared_ptr<F_Record>> m_fRecords;
+	std::vector<std::shared_ptr<K_Record>> m_kRecords;
+	std::vector<std::shared_ptr<D_Record>> m_dRecords;
 public:
 	FlightRecord();
 	~FlightRecord() = default;
@@ -571,14 +830,53 @@ public:
 	void setHRecord(H_Record& rec) {
 		m_hRecord = std::make_shared<H_Record>(rec);
 	}
+	void setIRecord(I_Record& rec) {
+		m_iRecord = std::make_shared<I_Record>(rec);
+	}
 	void insertBRecord(B_Record& rec) {
 		m_bRecords.push_back(std::make_shared<B_Record>(rec));
 	}
+	void insertERecord(E_Record& rec) {
+		m_eRecords.push_back(std::make_shared<E_Record>(rec));
+	}
+	void insertFRecord(F_Record& rec) {
+		m_fRecords.push_back(std::make_shared<F_Record>(rec));
+	}
+	void insertKRecord(K_Record& rec) {
+		m_kRecords.push_back(std::make_shared<K_Record>(rec));
+	}
+	void insertDRecord(D_Record& rec) {
+		m_dRecords.push_back(std::make_shared<D_Record>(rec));
+	}
+	std::shared_ptr<A_Record> getARecord() const {
+		return m_aRecord;
+	}
+	std::shared_ptr<H_Record> getHRecord() const {
+		return m_hRecord;
+	}
+	std::shared_ptr<I_Record> getIRecord() const {
+		return m_iRecord;
+	}
+	const std::vector<std::shared_ptr<B_Record>>& getBRecords() const {
+		return m_bRecords;
+	}
+	const std::vector<std::shared_ptr<E_Record>>& getERecords() const {
+		return m_eRecords;
+	}
+	const std::vector<std::shared_ptr<F_Record>>& getFRecords() const {
+		return m_fRecords;
+	}
+	const std::vector<std::shared_ptr<K_Record>>& getKRecords() const {
+		return m_kRecords;
+	}
+	const std::vector<std::shared_ptr<D_Record>>& getDRecords() const {
+		return m_dRecords;
+	}
 };
 
 FlightRecord::FlightRecord() {
-	
-	
+	m_aRecord = std::make_shared<A_Record>();
+	m_hRecord = std::make_shared<H_Record>();
 }
 
 void FlightRecord::print() {
@@ -601,48 +899,84 @@ bool IGCFile::read(const char* datafile, FlightRecord& flightRecord) {
 return false;
 	}
 	bool res = true;
-	H_Record hRecord;
-	A_Record aRecord;
 	while (std::getline(file, text)) {
-		char recordTypeChar = text[0];
-		//printf("Record type: %c\n", recordTypeChar);
-		switch ((RecordType)recordTypeChar) {
-		case RecordType::A_Record: // - FR manufacturer and identification(always first)
-			aRecord.parse(text.c_str());
-			break;
-		case RecordType::H_Record: // - File header
-			hRecord.parse(text.c_str());
-			break;
-		case RecordType::I_Record: // - Fix extension list, of data added at end of each B record
-			break;
-		case RecordType::J_Record: // - Extension list of data in each K record line
-			break;
-		case RecordType::C_Record: // - Task / declaration(if used)
-			break;
-		case RecordType::L_Record: // - Logbook / comments(if used)
-			break;
-		case RecordType::D_Record: // - Differential GPS(if used)
-			break;
-		case RecordType::F_Record: // - Initial Satellite Constellation
-			break;
-		case RecordType::B_Record: // - Fix plus any extension data listed in I Record
-		{
-			B_Record bRecord(text.c_str());
+		parse(text, flightRecord);
+	}
+	file.close();
+	return res;
+}
+
+// Parses one line of an IGC file into the flight record.
+void IGCFile::parse(std::string& text, FlightRecord& flightRecord) {
+	if (text.empty() == false && text.back() == '\r') {
+		text.pop_back();
+	}
+	char recordTypeChar = text[0];
+	//printf("Record type: %c\n", recordTypeChar);
+	switch ((RecordType)recordTypeChar) {
+	case RecordType::A_Record: // - FR manufacturer and identification(always first)
+		flightRecord.getARecord()->parse(text.c_str());
+		break;
+	case RecordType::H_Record: // - File header
+		flightRecord.getHRecord()->parse(text.c_str());
+		break;
+	case RecordType::I_Record: // - Fix extension list, of data added at end of each B record
+	{
+		I_Record iRecord(text.c_str());
+		if (iRecord.isValid()) {
+			flightRecord.setIRecord(iRecord);
+		}
+		break;
+	}
+	case RecordType::J_Record: // - Extension list of data in each K record line
+		break;
+	case RecordType::C_Record: // - Task / declaration(if used)
+		break;
+	case RecordType::L_Record: // - Logbook / comments(if used)
+		break;
+	case RecordType::D_Record: // - Differential GPS(if used)
+	{
+		D_Record dRecord(text.c_str());
+		if (dRecord.isValid()) {
+			flightRecord.insertDRecord(dRecord);
+		}
+		break;
+	}
+	case RecordType::F_Record: // - Initial Satellite Constellation
+	{
+		F_Record fRecord(text.c_str());
+		if (fRecord.isValid()) {
+			flightRecord.insertFRecord(fRecord);
+		}
+		break;
+	}
+	case RecordType::B_Record: // - Fix plus any extension data listed in I Record
+	{
+		B_Record bRecord(text.c_str(), text.length());
+		if (bRecord.isValid()) {
 			flightRecord.insertBRecord(bRecord);
-			break;
 		}
-		case RecordType::E_Record: // - Pilot Event(PEV)
-			break;
-		case RecordType::K_Record: // - Extension data as defined in J Record
-			break;
-		case RecordType::G_Record: // - Security record(always last)
-			break;
+		break;
+	}
+	case RecordType::E_Record: // - Pilot Event(PEV)
+	{
+		E_Record eRecord(text.c_str());
+		if (eRecord.isValid()) {
+			flightRecord.insertERecord(eRecord);
 		}
+		break;
+	}
+	case RecordType::K_Record: // - Extension data as defined in J Record
+	{
+		K_Record kRecord(text.c_str());
+		if (kRecord.isValid()) {
+			flightRecord.insertKRecord(kRecord);
+		}
+		break;
+	}
+	case RecordType::G_Record: // - Security record(always last)
+		break;
 	}
-	flightRecord.setARecord(aRecord);
-	flightRecord.setHRecord(hRecord);
-	file.close();
-	return res;
 }
 
 
@@ -677,18 +1011,41 @@ public:
 };
 
 class FlightSummary {
-	std::string m_location;
+	std::string m_location;			// Take-off position, an IGC file has no site name
 	std::string m_date;
 	std::string m_wing;
-	std::string m_duration;
-	std::string m_maxDistance;
-	std::string m_maxAltitude;
-	std::string m_trackLength;
-	std::string m_averageSpeed;
-	std::string m_altitudeGain;
+	int m_duration{ 0 };			// seconds
+	double m_maxDistance{ 0.0 };	// meters from take-off
+	int m_maxAltitude{ 0 };			// meters
+	double m_trackLength{ 0.0 };	// meters
+	double m_averageSpeed{ 0.0 };	// km/h
+	int m_altitudeGain{ 0 };		// meters, sum of all climbs
+	// Fixes added so far, the next fix continues from the last one
+	size_t m_fixes{ 0 };
+	size_t m_positions{ 0 };
+	int m_lastTime{ 0 };
+	double m_startLat{ 0.0 };
+	double m_startLong{ 0.0 };
+	double m_lastLat{ 0.0 };
+	double m_lastLong{ 0.0 };
+	int m_lastAltitude{ 0 };
 public:
 	FlightSummary() = default;
 	~FlightSummary() = default;
+	void setHeader(const H_Record& hRecord);
+	void addFix(const B_Record& bRecord);
+	void update(const FlightRecord& flightRecord);
+	std::string getLocation() const { return m_location; };
+	std::string getDate() const { return m_date; };
+	std::string getWing() const { return m_wing; };
+	int getDuration() const { return m_duration; };
+	double getMaxDistance() const { return m_maxDistance; };
+	int getMaxAltitude() const { return m_maxAltitude; };
+	double getTrackLength() const { return m_trackLength; };
+	double getAverageSpeed() const { return m_averageSpeed; };
+	int getAltitudeGain() const { return m_altitudeGain; };
+	size_t getNumberOfFixes() const { return m_fixes; };
+	void print();
 };
 
 #include <cmath>
@@ -754,18 +1111,2376 @@ public:
 	Location(double lat, double lon) : m_lat(lat), m_long(lon) {};
 };
 
+void FlightSummary::setHeader(const H_Record& hRecord)
+{
+	m_date = hRecord.getUTCDate();
+	m_wing = hRecord.getGliderModel();
+}
 
-int main(int argc, char* argv[])
+// Adds the next fix of the flight. Altitudes are GNSS, or pressure if GNSS was not recorded.
+void FlightSummary::addFix(const B_Record& bRecord)
 {
-	double dist = calcGPSDistance(51.55069, 001.55616, 51.55068, 001.55616);
-	printf("Dist %f\n", dist);
+	m_fixes++;
+	double lat = bRecord.getLatitudeDegrees();
+	double lon = bRecord.getLongitudeDegrees();
+	if (lat == 0.0 && lon == 0.0) {
+		return;	// No GPS data yet
+	}
+	int time = bRecord.getTimeSeconds();
+	int altitude = (bRecord.getGNSSAltMeters() != 0) ? bRecord.getGNSSAltMeters() : bRecord.getPressAltMeters();
+	if (m_positions++ == 0) {
+		char location[32];
+		snprintf(location, sizeof(location), "%.2f%c %.2f%c", std::abs(lat), (lat < 0) ? 'S' : 'N', std::abs(lon), (lon < 0) ? 'W' : 'E');
+		m_location = location;
+		m_startLat = lat;
+		m_startLong = lon;
+		m_maxAltitude = altitude;
+	}
+	else {
+		int elapsed = time - m_lastTime;
+		if (elapsed < 0) {
+			elapsed += 24 * 3600;	// Flight over midnight UTC
+		}
+		m_duration += elapsed;
+		m_trackLength += calcGPSDistance(lat, lon, m_lastLat, m_lastLong);
+		m_maxDistance = std::max(m_maxDistance, calcGPSDistance(lat, lon, m_startLat, m_startLong));
+		m_maxAltitude = std::max(m_maxAltitude, altitude);
+		if (altitude > m_lastAltitude) {
+			m_altitudeGain += altitude - m_lastAltitude;
+		}
+		m_averageSpeed = (m_duration > 0) ? (m_trackLength / m_duration) * 3.6 : 0.0;
+	}
+	m_lastTime = time;
+	m_lastLat = lat;
+	m_lastLong = lon;
+	m_lastAltitude = altitude;
+}
 
-	if (argc < 2) {
+// Adds the fixes of the flight record not added yet, so it can be called again as the flight grows.
+void FlightSummary::update(const FlightRecord& flightRecord)
+{
+	setHeader(*flightRecord.getHRecord());
+	auto& bRecords = flightRecord.getBRecords();
+	while (m_fixes < bRecords.size()) {
+		addFix(*bRecords[m_fixes]);
+	}
+}
+
+void FlightSummary::print()
+{
+	if (m_date.length() != 0) { printf("Date: %s\n", m_date.c_str()); }
+	if (m_wing.length() != 0) { printf("Wing: %s\n", m_wing.c_str()); }
+	if (m_location.length() != 0) { printf("Location: %s\n", m_location.c_str()); }
+	printf("Duration: %02d:%02d:%02d\n", m_duration / 3600, (m_duration / 60) % 60, m_duration % 60);
+	printf("Max Distance: %.1f km\n", m_maxDistance / 1000.0);
+	printf("Max Altitude: %d m\n", m_maxAltitude);
+	printf("Track Length: %.1f km\n", m_trackLength / 1000.0);
+	printf("Average Speed: %.1f km/h\n", m_averageSpeed);
+	printf("Altitude Gain: %d m\n", m_altitudeGain);
+}
+
+/*
+Live IGC files
+
+IGCTail follows an IGC file that is still being written, e.g. by a tracking kiosk. Every update
+reads only the bytes appended since the last update, parses the complete lines and keeps an
+incomplete last line for the next update. The parser state (header fields seen, I record) is the
+flight record itself, and the summary only adds the new fixes, so an update costs in proportion
+to the new data and not the file size. If the file gets shorter it was replaced and is read again
+from the start.
+*/
+class IGCTail {
+	std::string m_path;
+	uint64_t m_offset{ 0 };
+	std::string m_buffer;
+	std::string m_line;			// Incomplete last line
+	IGCFile m_igcFile;
+	FlightRecord m_flightRecord;
+	FlightSummary m_summary;
+public:
+	IGCTail(const char* datafile) : m_path(datafile) {};
+	~IGCTail() = default;
+	int update();
+	void reset();
+	std::string getPath() const { return m_path; };
+	uint64_t getOffset() const { return m_offset; };
+	const FlightRecord& getFlightRecord() const { return m_flightRecord; };
+	const FlightSummary& getSummary() const { return m_summary; };
+	FlightSummary& getSummary() { return m_summary; };
+};
+
+void IGCTail::reset()
+{
+	m_offset = 0;
+	m_line.clear();
+	m_flightRecord = FlightRecord();
+	m_summary = FlightSummary();
+}
+
+// Returns the number of new lines parsed, or -1 if the file cannot be read.
+int IGCTail::update()
+{
+	std::error_code error;
+	uint64_t size = std::filesystem::file_size(m_path, error);
+	if (error) {
 		return -1;
 	}
-	if (argv[1] == nullptr) {
+	if (size < m_offset) {
+		reset();
+	}
+	if (size == m_offset) {
+		return 0;
+	}
+	std::ifstream file(m_path, std::ios::binary);
+	if (file.is_open() == false) {
 		return -1;
 	}
+	file.seekg((std::streamoff)m_offset);
+	m_buffer.resize((size_t)(size - m_offset));
+	file.read(&m_buffer[0], (std::streamsize)m_buffer.size());
+	m_buffer.resize((size_t)file.gcount());
+	m_offset += m_buffer.size();
+	file.close();
+
+	int lines = 0;
+	size_t start = 0;
+	while (start < m_buffer.size()) {
+		size_t end = m_buffer.find('\n', start);
+		if (end == std::string::npos) {
+			m_line.append(m_buffer, start, std::string::npos);
+			break;
+		}
+		m_line.append(m_buffer, start, end - start);
+		m_igcFile.parse(m_line, m_flightRecord);
+		m_line.clear();
+		lines++;
+		start = end + 1;
+	}
+	m_summary.update(m_flightRecord);
+	return lines;
+}
+
+/*
+Flight fingerprints
+
+A fingerprint is a compact signature of one flight computed from its decoded B records. It is used
+to find the same flight uploaded twice (e.g. from a vario and from a phone with different A records)
+and to find flights that were flown together (tandem and competition cross-checks).
+
+	Date				HFDTE of the file
+	Start / End			Position quantized to 1/1000 degree (about 100m) and time in seconds UTC
+	Track hashes		MinHash of the geohash cells (precision 7, about 150m x 150m) the track passes through.
+						Two logs of the same flight share almost all cells.
+	Airspace hashes		MinHash of coarser geohash cells (precision 6, about 1.2km x 0.6km) combined with a
+						5 minute time slot and the date. Pilots flying in the same gaggle share these cells even
+						when their own tracks differ.
+	Time samples		Interpolated positions at 16 of the whole minutes of the flight, picked by the
+						smallest hash of the minute. Two flights choose mostly the same minutes where they
+						overlap, so their positions can be compared at the same timestamps.
+
+The fraction of equal MinHash slots of two fingerprints estimates the Jaccard similarity of their cell sets.
+The track hashes have no time, pilots in the same thermal share most cells. They only select the
+candidates, a duplicate must also be within 50m of the other flight at the common time samples.
+*/
+enum class FlightMatch {
+	None,
+	FlewTogether,	// Same place at the same time
+	NearDuplicate,	// Mostly the same track, e.g. one logger started late
+	Duplicate		// The same flight
+};
+
+class FlightFingerprint {
+public:
+	static const int NumberOfHashes = 32;
+	static const int TrackPrecision = 7;
+	static const int AirspacePrecision = 6;
+	static const int AirspaceTimeSlot = 300;	// seconds
+	static const int PositionScale = 1000;		// 1/1000 degree
+	static const int NumberOfSamples = 16;
+	static const int SampleInterval = 60;		// seconds
+	static const int SampleDistance = 50;		// meters
+private:
+	struct TimeSample {
+		uint32_t m_hash;
+		int m_slot;			// Time / SampleInterval, continuous over midnight
+		double m_lat;
+		double m_long;
+	};
+	uint32_t m_date{ 0 };		// YYYYMMDD
+	int m_startTime{ 0 };
+	int m_endTime{ 0 };
+	int m_startLat{ 0 };
+	int m_startLong{ 0 };
+	int m_endLat{ 0 };
+	int m_endLong{ 0 };
+	std::array<uint32_t, NumberOfHashes> m_trackHashes;
+	std::array<uint32_t, NumberOfHashes> m_airspaceHashes;
+	std::array<TimeSample, NumberOfSamples> m_samples;
+	int m_numberOfSamples{ 0 };
+	bool m_valid{ false };
+
+	static uint64_t mix(uint64_t x);
+	static uint64_t geohashCell(double lat, double lon, int precision);
+	static void addToMinHash(std::array<uint32_t, NumberOfHashes>& hashes, uint64_t cell);
+	static double similarity(const std::array<uint32_t, NumberOfHashes>& a, const std::array<uint32_t, NumberOfHashes>& b);
+	void addSample(int slot, double lat, double lon, uint64_t dateHash);
+public:
+	FlightFingerprint() = default;
+	~FlightFingerprint() = default;
+	bool compute(const FlightRecord& flightRecord);
+	bool isValid() const { return m_valid; };
+	uint32_t getDate() const { return m_date; };
+	int getStartTime() const { return m_startTime; };
+	int getEndTime() const { return m_endTime; };
+	const std::array<uint32_t, NumberOfHashes>& getTrackHashes() const { return m_trackHashes; };
+	const std::array<uint32_t, NumberOfHashes>& getAirspaceHashes() const { return m_airspaceHashes; };
+	double trackSimilarity(const FlightFingerprint& other) const;
+	double airspaceSimilarity(const FlightFingerprint& other) const;
+	double timeOverlap(const FlightFingerprint& other) const;
+	int alignedSamples(const FlightFingerprint& other, int& close) const;
+	FlightMatch match(const FlightFingerprint& other) const;
+	void print();
+};
+
+// SplitMix64 finalizer
+uint64_t FlightFingerprint::mix(uint64_t x)
+{
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// Geohash as an integer (5 bits per character, longitude first) instead of a base32 string.
+uint64_t FlightFingerprint::geohashCell(double lat, double lon, int precision)
+{
+	double latMin = -90.0, latMax = 90.0;
+	double lonMin = -180.0, lonMax = 180.0;
+	uint64_t cell = 0;
+	int bits = precision * 5;
+	for (int i = 0; i < bits; i++) {
+		cell <<= 1;
+		if ((i & 1) == 0) {
+			double mid = (lonMin + lonMax) / 2;
+			if (lon >= mid) {
+				cell |= 1;
+				lonMin = mid;
+			}
+			else {
+				lonMax = mid;
+			}
+		}
+		else {
+			double mid = (latMin + latMax) / 2;
+			if (lat >= mid) {
+				cell |= 1;
+				latMin = mid;
+			}
+			else {
+				latMax = mid;
+			}
+		}
+	}
+	return cell;
+}
+
+void FlightFingerprint::addToMinHash(std::array<uint32_t, NumberOfHashes>& hashes, uint64_t cell)
+{
+	uint64_t h = mix(cell);
+	for (int i = 0; i < NumberOfHashes; i++) {
+		uint32_t value = (uint32_t)(mix(h + (uint64_t)(i + 1) * 0xD6E8FEB86659FD93ULL) >> 32);
+		if (value < hashes[i]) {
+			hashes[i] = value;
+		}
+	}
+}
+
+double FlightFingerprint::similarity(const std::array<uint32_t, NumberOfHashes>& a, const std::array<uint32_t, NumberOfHashes>& b)
+{
+	int equal = 0;
+	for (int i = 0; i < NumberOfHashes; i++) {
+		if (a[i] == b[i]) {
+			equal++;
+		}
+	}
+	return (double)equal / NumberOfHashes;
+}
+
+// Keeps the samples with the smallest hashes, as a max heap on the hash.
+void FlightFingerprint::addSample(int slot, double lat, double lon, uint64_t dateHash)
+{
+	auto compare = [](const TimeSample& a, const TimeSample& b) { return a.m_hash < b.m_hash; };
+	TimeSample sample = { (uint32_t)(mix(dateHash ^ (uint64_t)slot) >> 32), slot, lat, lon };
+	if (m_numberOfSamples < NumberOfSamples) {
+		m_samples[m_numberOfSamples++] = sample;
+		std::push_heap(m_samples.begin(), m_samples.begin() + m_numberOfSamples, compare);
+		return;
+	}
+	if (sample.m_hash >= m_samples.front().m_hash) {
+		return;
+	}
+	std::pop_heap(m_samples.begin(), m_samples.end(), compare);
+	m_samples.back() = sample;
+	std::push_heap(m_samples.begin(), m_samples.end(), compare);
+}
+
+bool FlightFingerprint::compute(const FlightRecord& flightRecord)
+{
+	m_valid = false;
+	m_numberOfSamples = 0;
+	m_trackHashes.fill(UINT32_MAX);
+	m_airspaceHashes.fill(UINT32_MAX);
+	m_date = flightRecord.getHRecord()->getDate();
+	uint64_t dateHash = mix(m_date);
+
+	uint64_t lastTrackCell = UINT64_MAX;
+	uint64_t lastAirspaceCell = UINT64_MAX;
+	int dayOffset = 0;
+	int lastTime = 0;
+	double lastLat = 0.0;
+	double lastLong = 0.0;
+	bool first = true;
+	for (auto item : flightRecord.getBRecords()) {
+		double lat = item->getLatitudeDegrees();
+		double lon = item->getLongitudeDegrees();
+		if (lat == 0.0 && lon == 0.0) {
+			continue;	// No GPS data yet
+		}
+		int time = item->getTimeSeconds();
+		int quantLat = (int)std::lround(lat * PositionScale);
+		int quantLong = (int)std::lround(lon * PositionScale);
+		if (first) {
+			m_startTime = time;
+			m_startLat = quantLat;
+			m_startLong = quantLong;
+			if (time % SampleInterval == 0) {
+				addSample(time / SampleInterval, lat, lon, dateHash);
+			}
+			first = false;
+		}
+		else {
+			int sampleTime = time + dayOffset;
+			if (sampleTime < lastTime - (12 * 3600)) {
+				dayOffset += 24 * 3600;	// Flight over midnight UTC
+				sampleTime += 24 * 3600;
+			}
+			// Whole minutes after the last fix up to this fix, not over gaps in the log
+			if (sampleTime > lastTime && sampleTime - lastTime <= 5 * SampleInterval) {
+				for (int slot = lastTime / SampleInterval + 1; slot * SampleInterval <= sampleTime; slot++) {
+					double f = (double)(slot * SampleInterval - lastTime) / (sampleTime - lastTime);
+					addSample(slot, lastLat + f * (lat - lastLat), lastLong + f * (lon - lastLong), dateHash);
+				}
+			}
+		}
+		lastTime = time + dayOffset;
+		lastLat = lat;
+		lastLong = lon;
+		m_endTime = time;
+		m_endLat = quantLat;
+		m_endLong = quantLong;
+
+		// Consecutive fixes are mostly in the same cell, only hash when the cell changes.
+		uint64_t trackCell = geohashCell(lat, lon, TrackPrecision);
+		if (trackCell != lastTrackCell) {
+			addToMinHash(m_trackHashes, trackCell);
+			lastTrackCell = trackCell;
+		}
+		uint64_t airspaceCell = geohashCell(lat, lon, AirspacePrecision);
+		airspaceCell = (airspaceCell << 17) ^ (uint64_t)(time / AirspaceTimeSlot);
+		airspaceCell = mix(airspaceCell ^ dateHash);
+		if (airspaceCell != lastAirspaceCell) {
+			addToMinHash(m_airspaceHashes, airspaceCell);
+			lastAirspaceCell = airspaceCell;
+		}
+	}
+	if (first) {
+		return false;
+	}
+	if (m_endTime < m_startTime) {
+		m_endTime += 24 * 3600;	// Flight over midnight UTC
+	}
+	std::sort(m_samples.begin(), m_samples.begin() + m_numberOfSamples, [](const TimeSample& a, const TimeSample& b) {
+		return a.m_slot < b.m_slot;
+	});
+	m_valid = true;
+	return true;
+}
+
+double FlightFingerprint::trackSimilarity(const FlightFingerprint& other) const
+{
+	return similarity(m_trackHashes, other.m_trackHashes);
+}
+
+double FlightFingerprint::airspaceSimilarity(const FlightFingerprint& other) const
+{
+	return similarity(m_airspaceHashes, other.m_airspaceHashes);
+}
+
+// Overlap of the two flight times as a fraction of the shorter flight.
+double FlightFingerprint::timeOverlap(const FlightFingerprint& other) const
+{
+	if (m_date != other.m_date) {
+		return 0.0;
+	}
+	int start = std::max(m_startTime, other.m_startTime);
+	int end = std::min(m_endTime, other.m_endTime);
+	if (end <= start) {
+		return 0.0;
+	}
+	int shortest = std::min(m_endTime - m_startTime, other.m_endTime - other.m_startTime);
+	if (shortest <= 0) {
+		return 1.0;
+	}
+	return (double)(end - start) / shortest;
+}
+
+// Number of time samples both flights have, close is set to how many of them are within SampleDistance.
+int FlightFingerprint::alignedSamples(const FlightFingerprint& other, int& close) const
+{
+	int common = 0;
+	close = 0;
+	if (m_date != other.m_date) {
+		return 0;
+	}
+	int i = 0, j = 0;
+	while (i < m_numberOfSamples && j < other.m_numberOfSamples) {
+		const TimeSample& a = m_samples[i];
+		const TimeSample& b = other.m_samples[j];
+		if (a.m_slot < b.m_slot) {
+			i++;
+			continue;
+		}
+		if (b.m_slot < a.m_slot) {
+			j++;
+			continue;
+		}
+		common++;
+		if (calcGPSDistance(a.m_lat, a.m_long, b.m_lat, b.m_long) <= SampleDistance) {
+			close++;
+		}
+		i++;
+		j++;
+	}
+	return common;
+}
+
+FlightMatch FlightFingerprint::match(const FlightFingerprint& other) const
+{
+	if (m_valid == false || other.m_valid == false) {
+		return FlightMatch::None;
+	}
+	double overlap = timeOverlap(other);
+	if (overlap == 0.0) {
+		return FlightMatch::None;
+	}
+	if (trackSimilarity(other) >= 0.6) {
+		// Same positions at the same times, not only the same cells
+		int close = 0;
+		int common = alignedSamples(other, close);
+		if (common >= 4 && close * 10 >= common * 9) {
+			// Loggers started within a minute and 500m of each other
+			const int tolerance = PositionScale / 200;
+			if (overlap >= 0.8 &&
+				std::abs(m_startTime - other.m_startTime) <= 60 &&
+				std::abs(m_startLat - other.m_startLat) <= tolerance &&
+				std::abs(m_startLong - other.m_startLong) <= tolerance) {
+				return FlightMatch::Duplicate;
+			}
+			return FlightMatch::NearDuplicate;
+		}
+	}
+	if (airspaceSimilarity(other) >= 0.3) {
+		return FlightMatch::FlewTogether;
+	}
+	return FlightMatch::None;
+}
+
+void FlightFingerprint::print()
+{
+	printf("Date: %u ", m_date);
+	printf(" Start: %05d %.3f %.3f ", m_startTime, (double)m_startLat / PositionScale, (double)m_startLong / PositionScale);
+	printf(" End: %05d %.3f %.3f\n", m_endTime, (double)m_endLat / PositionScale, (double)m_endLong / PositionScale);
+}
+
+/*
+Index of flight fingerprints using locality sensitive hashing. The MinHash slots are split into
+bands and every band is a key into a bucket map, so a lookup only compares the flights sharing at
+least one band instead of the whole logbook.
+
+	Track		8 bands of 4 rows. Tuned for duplicates, a pair with similarity 0.8 is found 98% of the time.
+	Airspace	16 bands of 2 rows. Tuned for flew together, a pair with similarity 0.3 is found 78% of the time.
+
+Flights on different dates never match, so the flight date is part of every band key. A bucket
+only holds the flights of one day, a busy take-off site used every day does not make it grow.
+The airspace cells include the time as well.
+*/
+class FlightIndex {
+	static const int TrackRows = 4;
+	static const int AirspaceRows = 2;
+
+	typedef std::unordered_map<uint64_t, std::vector<uint32_t>> Buckets;
+	std::vector<FlightFingerprint> m_flights;
+	Buckets m_trackBuckets;
+	Buckets m_airspaceBuckets;
+
+	static uint64_t bandKey(const std::array<uint32_t, FlightFingerprint::NumberOfHashes>& hashes, int band, int rows, uint32_t date);
+	static void insertBands(Buckets& buckets, const std::array<uint32_t, FlightFingerprint::NumberOfHashes>& hashes, int rows, uint32_t date, uint32_t id);
+	static void findBands(const Buckets& buckets, const std::array<uint32_t, FlightFingerprint::NumberOfHashes>& hashes, int rows, uint32_t date, std::unordered_set<uint32_t>& seen, std::vector<uint32_t>& candidates);
+public:
+	FlightIndex() = default;
+	~FlightIndex() = default;
+	size_t insert(const FlightFingerprint& fingerprint);
+	size_t size() const { return m_flights.size(); };
+	const FlightFingerprint& at(size_t id) const { return m_flights[id]; };
+	std::vector<std::pair<size_t, FlightMatch>> find(const FlightFingerprint& fingerprint, FlightMatch minimum) const;
+	std::vector<std::vector<size_t>> groups(FlightMatch minimum) const;
+};
+
+uint64_t FlightIndex::bandKey(const std::array<uint32_t, FlightFingerprint::NumberOfHashes>& hashes, int band, int rows, uint32_t date)
+{
+	uint64_t key = ((uint64_t)date << 8) | (uint64_t)band;
+	for (int i = band * rows; i < (band + 1) * rows; i++) {
+		key = (key * 0x100000001B3ULL) ^ hashes[i];
+	}
+	return key;
+}
+
+void FlightIndex::insertBands(Buckets& buckets, const std::array<uint32_t, FlightFingerprint::NumberOfHashes>& hashes, int rows, uint32_t date, uint32_t id)
+{
+	for (int band = 0; band < FlightFingerprint::NumberOfHashes / rows; band++) {
+		buckets[bandKey(hashes, band, rows, date)].push_back(id);
+	}
+}
+
+// Adds the flights of the matching buckets not seen in an earlier band.
+void FlightIndex::findBands(const Buckets& buckets, const std::array<uint32_t, FlightFingerprint::NumberOfHashes>& hashes, int rows, uint32_t date, std::unordered_set<uint32_t>& seen, std::vector<uint32_t>& candidates)
+{
+	for (int band = 0; band < FlightFingerprint::NumberOfHashes / rows; band++) {
+		auto bucket = buckets.find(bandKey(hashes, band, rows, date));
+		if (bucket == buckets.end()) {
+			continue;
+		}
+		for (auto id : bucket->second) {
+			if (seen.insert(id).second) {
+				candidates.push_back(id);
+			}
+		}
+	}
+}
+
+size_t FlightIndex::insert(const FlightFingerprint& fingerprint)
+{
+	uint32_t id = (uint32_t)m_flights.size();
+	m_flights.push_back(fingerprint);
+	if (fingerprint.isValid()) {
+		insertBands(m_trackBuckets, fingerprint.getTrackHashes(), TrackRows, fingerprint.getDate(), id);
+		insertBands(m_airspaceBuckets, fingerprint.getAirspaceHashes(), AirspaceRows, fingerprint.getDate(), id);
+	}
+	return id;
+}
+
+// Returns the indexed flights matching at least the minimum match level, best match first.
+std::vector<std::pair<size_t, FlightMatch>> FlightIndex::find(const FlightFingerprint& fingerprint, FlightMatch minimum) const
+{
+	std::vector<std::pair<size_t, FlightMatch>> result;
+	if (fingerprint.isValid() == false || minimum == FlightMatch::None) {
+		return result;
+	}
+	std::unordered_set<uint32_t> seen;
+	std::vector<uint32_t> candidates;
+	findBands(m_trackBuckets, fingerprint.getTrackHashes(), TrackRows, fingerprint.getDate(), seen, candidates);
+	if (minimum == FlightMatch::FlewTogether) {
+		findBands(m_airspaceBuckets, fingerprint.getAirspaceHashes(), AirspaceRows, fingerprint.getDate(), seen, candidates);
+	}
+	std::sort(candidates.begin(), candidates.end());
+	for (auto id : candidates) {
+		FlightMatch match = fingerprint.match(m_flights[id]);
+		if (match >= minimum) {
+			result.emplace_back(id, match);
+		}
+	}
+	std::stable_sort(result.begin(), result.end(), [](const std::pair<size_t, FlightMatch>& a, const std::pair<size_t, FlightMatch>& b) {
+		return a.second > b.second;
+	});
+	return result;
+}
+
+// Groups of two or more indexed flights connected by matches of at least the minimum level.
+std::vector<std::vector<size_t>> FlightIndex::groups(FlightMatch minimum) const
+{
+	std::vector<size_t> parent(m_flights.size());
+	for (size_t i = 0; i < parent.size(); i++) {
+		parent[i] = i;
+	}
+	auto root = [&parent](size_t i) {
+		while (parent[i] != i) {
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	};
+	for (size_t i = 0; i < m_flights.size(); i++) {
+		for (auto& item : find(m_flights[i], minimum)) {
+			size_t a = root(i);
+			size_t b = root(item.first);
+			if (a != b) {
+				parent[std::max(a, b)] = std::min(a, b);
+			}
+		}
+	}
+	std::unordered_map<size_t, std::vector<size_t>> members;
+	for (size_t i = 0; i < m_flights.size(); i++) {
+		members[root(i)].push_back(i);
+	}
+	std::vector<std::vector<size_t>> result;
+	for (auto& item : members) {
+		if (item.second.size() > 1) {
+			result.push_back(item.second);
+		}
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+/*
+Multi-flight replay
+
+A FlightTrack is the columnar form of the B records of one flight: one array per field with
+the time in seconds instead of strings. Times are made monotonic, a flight over midnight UTC
+continues past 86400 and repeated fixes are dropped.
+
+FlightReplay merges many tracks into one synchronized stream of positions at a fixed time step.
+Each step interpolates the position of every pilot between the fixes either side of the replay
+time. The tracks are advanced with a min-heap of their next fix times, so a step only touches
+the tracks that have a new fix. All buffers are sized when the replay starts, stepping does not
+allocate.
+
+The leader is the pilot closest to the goal when a goal is set, otherwise the pilot furthest
+from their own take-off. The gap is the difference in that distance to the leader. When no pilot
+is flying at the replay time there is no leader, getLeader() returns SIZE_MAX.
+*/
+class FlightTrack {
+	std::vector<int> m_time;
+	std::vector<double> m_lat;
+	std::vector<double> m_long;
+	std::vector<int> m_pressAlt;
+	std::vector<int> m_gnssAlt;
+public:
+	FlightTrack() = default;
+	~FlightTrack() = default;
+	bool load(const FlightRecord& flightRecord);
+	size_t size() const { return m_time.size(); };
+	int getTime(size_t i) const { return m_time[i]; };
+	double getLatitude(size_t i) const { return m_lat[i]; };
+	double getLongitude(size_t i) const { return m_long[i]; };
+	int getPressAlt(size_t i) const { return m_pressAlt[i]; };
+	int getGNSSAlt(size_t i) const { return m_gnssAlt[i]; };
+	int getStartTime() const { return m_time.front(); };
+	int getEndTime() const { return m_time.back(); };
+	size_t find(int time) const;
+};
+
+bool FlightTrack::load(const FlightRecord& flightRecord)
+{
+	auto& bRecords = flightRecord.getBRecords();
+	m_time.clear();
+	m_lat.clear();
+	m_long.clear();
+	m_pressAlt.clear();
+	m_gnssAlt.clear();
+	m_time.reserve(bRecords.size());
+	m_lat.reserve(bRecords.size());
+	m_long.reserve(bRecords.size());
+	m_pressAlt.reserve(bRecords.size());
+	m_gnssAlt.reserve(bRecords.size());
+	int dayOffset = 0;
+	for (auto item : bRecords) {
+		double lat = item->getLatitudeDegrees();
+		double lon = item->getLongitudeDegrees();
+		if (lat == 0.0 && lon == 0.0) {
+			continue;	// No GPS data yet
+		}
+		int time = item->getTimeSeconds() + dayOffset;
+		if (m_time.empty() == false) {
+			if (time < m_time.back() - (12 * 3600)) {
+				dayOffset += 24 * 3600;
+				time += 24 * 3600;
+			}
+			if (time <= m_time.back()) {
+				continue;
+			}
+		}
+		m_time.push_back(time);
+		m_lat.push_back(lat);
+		m_long.push_back(lon);
+		m_pressAlt.push_back(item->getPressAltMeters());
+		m_gnssAlt.push_back(item->getGNSSAltMeters());
+	}
+	return m_time.empty() == false;
+}
+
+// Index of the last fix at or before the time, 0 if the time is before the first fix.
+size_t FlightTrack::find(int time) const
+{
+	auto pos = std::upper_bound(m_time.begin(), m_time.end(), time);
+	if (pos == m_time.begin()) {
+		return 0;
+	}
+	return (size_t)(pos - m_time.begin()) - 1;
+}
+
+struct ReplayPosition {
+	double m_lat{ 0.0 };
+	double m_long{ 0.0 };
+	int m_pressAlt{ 0 };
+	int m_gnssAlt{ 0 };
+	double m_distance{ 0.0 };	// To goal, or from take-off when there is no goal
+	double m_gap{ 0.0 };		// Distance behind the leader
+	bool m_active{ false };		// Replay time is within the flight
+};
+
+class FlightReplay {
+	typedef std::pair<int, size_t> HeapEntry;	// Next fix time, track
+	std::vector<FlightTrack> m_tracks;
+	std::vector<size_t> m_cursors;
+	std::vector<HeapEntry> m_heap;
+	std::vector<ReplayPosition> m_positions;
+	int m_time{ 0 };
+	int m_step{ 1 };
+	int m_startTime{ 0 };
+	int m_endTime{ 0 };
+	bool m_hasGoal{ false };
+	double m_goalLat{ 0.0 };
+	double m_goalLong{ 0.0 };
+	size_t m_leader{ SIZE_MAX };
+
+	void advance();
+	void update();
+public:
+	FlightReplay() = default;
+	~FlightReplay() = default;
+	size_t addTrack(FlightTrack&& track);
+	void setGoal(double lat, double lon);
+	bool start(int step);
+	bool next();
+	void seek(int time);
+	int getTime() const { return m_time; };
+	int getStartTime() const { return m_startTime; };
+	int getEndTime() const { return m_endTime; };
+	size_t getLeader() const { return m_leader; };	// SIZE_MAX if no pilot is flying
+	const std::vector<ReplayPosition>& getPositions() const { return m_positions; };
+};
+
+size_t FlightReplay::addTrack(FlightTrack&& track)
+{
+	m_tracks.push_back(std::move(track));
+	return m_tracks.size() - 1;
+}
+
+void FlightReplay::setGoal(double lat, double lon)
+{
+	m_hasGoal = true;
+	m_goalLat = lat;
+	m_goalLong = lon;
+}
+
+// Starts at the first fix of the earliest flight. Returns false if there is nothing to replay.
+bool FlightReplay::start(int step)
+{
+	if (m_tracks.empty() || step <= 0) {
+		return false;
+	}
+	m_step = step;
+	m_startTime = m_tracks.front().getStartTime();
+	m_endTime = m_tracks.front().getEndTime();
+	for (auto& track : m_tracks) {
+		m_startTime = std::min(m_startTime, track.getStartTime());
+		m_endTime = std::max(m_endTime, track.getEndTime());
+	}
+	m_cursors.assign(m_tracks.size(), 0);
+	m_positions.assign(m_tracks.size(), ReplayPosition());
+	m_heap.clear();
+	m_heap.reserve(m_tracks.size());
+	seek(m_startTime);
+	return true;
+}
+
+// Moves to any time, e.g. when scrubbing. Costs a binary search per track.
+void FlightReplay::seek(int time)
+{
+	m_time = time;
+	m_heap.clear();
+	for (size_t i = 0; i < m_tracks.size(); i++) {
+		m_cursors[i] = m_tracks[i].find(time);
+		if (m_cursors[i] + 1 < m_tracks[i].size()) {
+			m_heap.emplace_back(m_tracks[i].getTime(m_cursors[i] + 1), i);
+		}
+	}
+	std::make_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+	update();
+}
+
+// Advances one time step, the last step stops at the end of the last flight. Returns false at the end.
+bool FlightReplay::next()
+{
+	if (m_time >= m_endTime) {
+		return false;
+	}
+	m_time = std::min(m_time + m_step, m_endTime);
+	advance();
+	update();
+	return true;
+}
+
+// Moves the cursor of every track whose next fix is now in the past.
+void FlightReplay::advance()
+{
+	while (m_heap.empty() == false && m_heap.front().first <= m_time) {
+		std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+		size_t i = m_heap.back().second;
+		m_heap.pop_back();
+		const FlightTrack& track = m_tracks[i];
+		size_t cursor = m_cursors[i];
+		while (cursor + 1 < track.size() && track.getTime(cursor + 1) <= m_time) {
+			cursor++;
+		}
+		m_cursors[i] = cursor;
+		if (cursor + 1 < track.size()) {
+			m_heap.emplace_back(track.getTime(cursor + 1), i);
+			std::push_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+		}
+	}
+}
+
+void FlightReplay::update()
+{
+	bool found = false;
+	m_leader = SIZE_MAX;
+	for (size_t i = 0; i < m_tracks.size(); i++) {
+		const FlightTrack& track = m_tracks[i];
+		ReplayPosition& position = m_positions[i];
+		position.m_active = (m_time >= track.getStartTime() && m_time <= track.getEndTime());
+		if (position.m_active == false) {
+			continue;
+		}
+		size_t cursor = m_cursors[i];
+		if (cursor + 1 < track.size()) {
+			double f = (double)(m_time - track.getTime(cursor)) / (track.getTime(cursor + 1) - track.getTime(cursor));
+			position.m_lat = track.getLatitude(cursor) + f * (track.getLatitude(cursor + 1) - track.getLatitude(cursor));
+			position.m_long = track.getLongitude(cursor) + f * (track.getLongitude(cursor + 1) - track.getLongitude(cursor));
+			position.m_pressAlt = track.getPressAlt(cursor) + (int)std::lround(f * (track.getPressAlt(cursor + 1) - track.getPressAlt(cursor)));
+			position.m_gnssAlt = track.getGNSSAlt(cursor) + (int)std::lround(f * (track.getGNSSAlt(cursor + 1) - track.getGNSSAlt(cursor)));
+		}
+		else {
+			position.m_lat = track.getLatitude(cursor);
+			position.m_long = track.getLongitude(cursor);
+			position.m_pressAlt = track.getPressAlt(cursor);
+			position.m_gnssAlt = track.getGNSSAlt(cursor);
+		}
+		if (m_hasGoal) {
+			position.m_distance = calcGPSDistance(position.m_lat, position.m_long, m_goalLat, m_goalLong);
+		}
+		else {
+			position.m_distance = calcGPSDistance(position.m_lat, position.m_long, track.getLatitude(0), track.getLongitude(0));
+		}
+		if (found == false) {
+			m_leader = i;
+			found = true;
+		}
+		else if (m_hasGoal ? (position.m_distance < m_positions[m_leader].m_distance) : (position.m_distance > m_positions[m_leader].m_distance)) {
+			m_leader = i;
+		}
+	}
+	if (found == false) {
+		for (auto& position : m_positions) {
+			position.m_gap = 0.0;
+		}
+		return;
+	}
+	double leaderDistance = m_positions[m_leader].m_distance;
+	for (auto& position : m_positions) {
+		position.m_gap = (position.m_active) ? std::abs(position.m_distance - leaderDistance) : 0.0;
+	}
+}
+
+/*
+Airspace
+
+Airspaces are read from OpenAir files. The records used are:
+
+	AC class			Airspace class, e.g. A, C, D, CTR, R, P, Q, GP
+	AN name				Airspace name
+	AL limit / AH limit	Lower and upper limit, e.g. SFC, GND, 2500ft AMSL, 1000ft AGL, FL95, 1500m, UNL
+	DP coordinate		Polygon point, e.g. 46:30:00 N 007:30:00 E or 46:30.500N 007:30.000E
+	V X=coordinate		Centre of the following arcs and circles
+	V D=+ or V D=-		Arc direction, clockwise or counter clockwise
+	DA radius,from,to	Arc of radius nm between two bearings
+	DB coord1,coord2	Arc from coord1 to coord2 around the centre
+	DC radius			Circle of radius nm
+
+Other records (SP, SB, AT, comments) are ignored. Arcs are converted to polygon points.
+There is no terrain model, so AGL limits above the ground are compared as if they were AMSL.
+*/
+enum class AltitudeReference {
+	Ground,			// SFC / GND
+	MSL,			// Compared with GNSS altitude
+	FlightLevel,	// Compared with pressure altitude
+	Unlimited
+};
+
+struct AirspaceLimit {
+	AltitudeReference m_reference{ AltitudeReference::Ground };
+	double m_meters{ 0.0 };
+};
+
+class Airspace {
+	std::string m_class;
+	std::string m_name;
+	AirspaceLimit m_lower;
+	AirspaceLimit m_upper;
+	std::vector<std::pair<double, double>> m_points;	// Latitude, longitude
+	bool m_circle{ false };
+	double m_centerLat{ 0.0 };
+	double m_centerLong{ 0.0 };
+	double m_radius{ 0.0 };		// meters
+public:
+	Airspace() = default;
+	~Airspace() = default;
+	std::string getClass() const { return m_class; };
+	std::string getName() const { return m_name; };
+	const AirspaceLimit& getLower() const { return m_lower; };
+	const AirspaceLimit& getUpper() const { return m_upper; };
+	const std::vector<std::pair<double, double>>& getPoints() const { return m_points; };
+	bool isCircle() const { return m_circle; };
+	double getCenterLatitude() const { return m_centerLat; };
+	double getCenterLongitude() const { return m_centerLong; };
+	double getRadius() const { return m_radius; };
+	bool isValid() const { return m_circle || m_points.size() >= 3; };
+	bool isInsideVertical(int pressAlt, int gnssAlt) const;
+	friend class OpenAirFile;
+};
+
+// True if the altitude is between the lower and upper limits. Flight levels use the pressure altitude,
+// all other limits the GNSS altitude. If one of the altitudes was not recorded (0) the other is used.
+bool Airspace::isInsideVertical(int pressAlt, int gnssAlt) const
+{
+	double pressure = (pressAlt != 0) ? pressAlt : gnssAlt;
+	double gnss = (gnssAlt != 0) ? gnssAlt : pressAlt;
+	switch (m_lower.m_reference) {
+	case AltitudeReference::Ground:
+		break;
+	case AltitudeReference::FlightLevel:
+		if (pressure < m_lower.m_meters) {
+			return false;
+		}
+		break;
+	default:
+		if (gnss < m_lower.m_meters) {
+			return false;
+		}
+		break;
+	}
+	switch (m_upper.m_reference) {
+	case AltitudeReference::Unlimited:
+		break;
+	case AltitudeReference::FlightLevel:
+		if (pressure > m_upper.m_meters) {
+			return false;
+		}
+		break;
+	default:
+		if (gnss > m_upper.m_meters) {
+			return false;
+		}
+		break;
+	}
+	return true;
+}
+
+class OpenAirFile {
+	static bool parseCoordinate(const std::string& text, double& lat, double& lon);
+	static AirspaceLimit parseLimit(const std::string& text);
+	static void addArc(Airspace& airspace, double centerLat, double centerLong, double radius, double from, double to, bool clockwise);
+public:
+	OpenAirFile() = default;
+	~OpenAirFile() = default;
+	bool read(const char* datafile, std::vector<Airspace>& airspaces);
+};
+
+const double METERS_PER_DEGREE = 111195.0;
+const double METERS_PER_NM = 1852.0;
+const double METERS_PER_FOOT = 0.3048;
+
+// Parses "46:30:00 N 007:30:00 E", "46:30.500N 007:30.000E" or "46:30:00N,007:30:00E".
+bool OpenAirFile::parseCoordinate(const std::string& text, double& lat, double& lon)
+{
+	int found = 0;
+	std::string number;
+	for (char c : text) {
+		if ((c >= '0' && c <= '9') || c == ':' || c == '.') {
+			number += c;
+			continue;
+		}
+		char hemisphere = (char)toupper(c);
+		if (hemisphere != 'N' && hemisphere != 'S' && hemisphere != 'E' && hemisphere != 'W') {
+			continue;
+		}
+		if (number.empty()) {
+			continue;
+		}
+		double value = 0.0;
+		double scale = 1.0;
+		size_t start = 0;
+		while (start <= number.length()) {
+			size_t end = number.find(':', start);
+			if (end == std::string::npos) {
+				end = number.length();
+			}
+			value += atof(number.substr(start, end - start).c_str()) / scale;
+			scale *= 60.0;
+			start = end + 1;
+		}
+		if (hemisphere == 'N' || hemisphere == 'S') {
+			lat = (hemisphere == 'S') ? -value : value;
+		}
+		else {
+			lon = (hemisphere == 'W') ? -value : value;
+		}
+		number.clear();
+		found++;
+	}
+	return found == 2;
+}
+
+AirspaceLimit OpenAirFile::parseLimit(const std::string& text)
+{
+	AirspaceLimit limit;
+	std::string upper;
+	for (char c : text) {
+		if (c != ' ' && c != '\t') {
+			upper += (char)toupper(c);
+		}
+	}
+	if (upper.find("UNL") == 0) {
+		limit.m_reference = AltitudeReference::Unlimited;
+		return limit;
+	}
+	if (upper.find("FL") == 0) {
+		limit.m_reference = AltitudeReference::FlightLevel;
+		limit.m_meters = atof(upper.substr(2).c_str()) * 100.0 * METERS_PER_FOOT;
+		return limit;
+	}
+	size_t end = 0;
+	while (end < upper.length() && ((upper[end] >= '0' && upper[end] <= '9') || upper[end] == '.')) {
+		end++;
+	}
+	if (end == 0) {
+		return limit;	// SFC or GND
+	}
+	double value = atof(upper.substr(0, end).c_str());
+	bool meters = (upper.compare(end, 1, "M") == 0 && upper.compare(end, 3, "MSL") != 0);
+	limit.m_reference = AltitudeReference::MSL;
+	limit.m_meters = (meters) ? value : value * METERS_PER_FOOT;
+	return limit;
+}
+
+// Adds polygon points along an arc, bearings in degrees. Points every 5 degrees.
+void OpenAirFile::addArc(Airspace& airspace, double centerLat, double centerLong, double radius, double from, double to, bool clockwise)
+{
+	double sweep = (clockwise) ? to - from : from - to;
+	while (sweep <= 0.0) {
+		sweep += 360.0;
+	}
+	while (sweep > 360.0) {
+		sweep -= 360.0;
+	}
+	int steps = std::max(1, (int)std::ceil(sweep / 5.0));
+	double cosLat = cos(toRadians(centerLat));
+	for (int i = 0; i <= steps; i++) {
+		double angle = from + ((clockwise) ? 1 : -1) * sweep * i / steps;
+		double lat = centerLat + radius * cos(toRadians(angle)) / METERS_PER_DEGREE;
+		double lon = centerLong + radius * sin(toRadians(angle)) / (METERS_PER_DEGREE * cosLat);
+		airspace.m_points.emplace_back(lat, lon);
+	}
+}
+
+bool OpenAirFile::read(const char* datafile, std::vector<Airspace>& airspaces)
+{
+	std::string text;
+
+	std::ifstream file(datafile);
+	if (file.is_open() == false) {
+		return false;
+	}
+	Airspace airspace;
+	bool inAirspace = false;
+	double centerLat = 0.0;
+	double centerLong = 0.0;
+	bool clockwise = true;
+	while (std::getline(file, text)) {
+		if (text.empty() == false && text.back() == '\r') {
+			text.pop_back();
+		}
+		if (text.length() < 2 || text[0] == '*') {
+			continue;
+		}
+		std::string type = text.substr(0, 2);
+		std::string value = text.substr(2);
+		value.erase(0, value.find_first_not_of(" \t"));
+		if (type.compare("AC") == 0) {
+			if (inAirspace && airspace.isValid()) {
+				airspaces.push_back(airspace);
+			}
+			airspace = Airspace();
+			airspace.m_class = value;
+			inAirspace = true;
+			clockwise = true;
+			continue;
+		}
+		if (inAirspace == false) {
+			continue;
+		}
+		if (type.compare("AN") == 0) {
+			airspace.m_name = value;
+		}
+		else if (type.compare("AL") == 0) {
+			airspace.m_lower = parseLimit(value);
+		}
+		else if (type.compare("AH") == 0) {
+			airspace.m_upper = parseLimit(value);
+		}
+		else if (type.compare("DP") == 0) {
+			double lat = 0.0, lon = 0.0;
+			if (parseCoordinate(value, lat, lon)) {
+				airspace.m_points.emplace_back(lat, lon);
+			}
+		}
+		else if (type.compare("V ") == 0) {
+			size_t equals = value.find('=');
+			if (equals == std::string::npos) {
+				continue;
+			}
+			std::string variable = value.substr(0, equals);
+			if (variable.find('X') != std::string::npos) {
+				parseCoordinate(value.substr(equals + 1), centerLat, centerLong);
+			}
+			else if (variable.find('D') != std::string::npos) {
+				clockwise = (value.find('-', equals) == std::string::npos);
+			}
+		}
+		else if (type.compare("DC") == 0) {
+			airspace.m_circle = true;
+			airspace.m_centerLat = centerLat;
+			airspace.m_centerLong = centerLong;
+			airspace.m_radius = atof(value.c_str()) * METERS_PER_NM;
+		}
+		else if (type.compare("DA") == 0) {
+			double radius = 0.0, from = 0.0, to = 0.0;
+			if (sscanf(value.c_str(), "%lf , %lf , %lf", &radius, &from, &to) == 3) {
+				addArc(airspace, centerLat, centerLong, radius * METERS_PER_NM, from, to, clockwise);
+			}
+		}
+		else if (type.compare("DB") == 0) {
+			size_t comma = value.find(',');
+			double lat1 = 0.0, lon1 = 0.0, lat2 = 0.0, lon2 = 0.0;
+			if (comma != std::string::npos &&
+				parseCoordinate(value.substr(0, comma), lat1, lon1) &&
+				parseCoordinate(value.substr(comma + 1), lat2, lon2)) {
+				double cosLat = cos(toRadians(centerLat));
+				double dy1 = (lat1 - centerLat), dx1 = (lon1 - centerLong) * cosLat;
+				double dy2 = (lat2 - centerLat), dx2 = (lon2 - centerLong) * cosLat;
+				double radius = sqrt(dx1 * dx1 + dy1 * dy1) * METERS_PER_DEGREE;
+				addArc(airspace, centerLat, centerLong, radius, toDegrees(atan2(dx1, dy1)), toDegrees(atan2(dx2, dy2)), clockwise);
+			}
+		}
+	}
+	if (inAirspace && airspace.isValid()) {
+		airspaces.push_back(airspace);
+	}
+	file.close();
+	return true;
+}
+
+struct AirspaceInfringement {
+	size_t m_airspace{ 0 };		// Index in the compiled airspaces
+	size_t m_firstFix{ 0 };		// Index in the track
+	size_t m_lastFix{ 0 };
+	int m_startTime{ 0 };
+	int m_endTime{ 0 };
+};
+
+/*
+Airspace index
+
+The airspaces are compiled into a uniform latitude / longitude grid. For every grid cell and every
+airspace touching it the index stores one entry:
+
+	Inside		The cell is completely inside the airspace, no lateral test needed
+	Polygon		The cell has polygon edges. The entry has the edges crossing the cell and whether the
+				cell centre is inside. A fix is inside if the centre is inside and the line from the
+				centre to the fix crosses an even number of edges, only the edges of the cell are tested.
+	Circle		The cell is crossed by the circle boundary, tested by distance to the centre
+
+Cells and entries are stored flat (offset arrays) so a fix lookup is one cell plus a few entries.
+*/
+class AirspaceIndex {
+	enum class EntryType : uint8_t { Inside, Polygon, Circle };
+	struct Edge {
+		double m_lat1, m_long1, m_lat2, m_long2;
+	};
+	struct Entry {
+		uint32_t m_airspace;
+		EntryType m_type;
+		bool m_centerInside;
+		uint32_t m_firstEdge;
+		uint32_t m_edgeCount;
+	};
+	struct Circle {
+		double m_lat, m_long, m_cosLat, m_radius2;	// radius squared in square degrees of latitude
+	};
+	std::vector<Airspace> m_airspaces;
+	std::vector<Circle> m_circles;			// By airspace
+	std::vector<uint32_t> m_cellOffsets;	// Entries of cell i are m_cellOffsets[i] to m_cellOffsets[i + 1]
+	std::vector<Entry> m_entries;
+	std::vector<Edge> m_edges;
+	double m_minLat{ 0.0 };
+	double m_minLong{ 0.0 };
+	double m_cellSize{ 0.05 };
+	int m_rows{ 0 };
+	int m_columns{ 0 };
+
+	static bool isInsidePolygon(const std::vector<Edge>& edges, double lat, double lon);
+	static bool crosses(const Edge& edge, double lat1, double lon1, double lat2, double lon2);
+	bool isInsideLateral(const Entry& entry, double lat, double lon, int row, int column) const;
+public:
+	AirspaceIndex() = default;
+	~AirspaceIndex() = default;
+	void compile(const std::vector<Airspace>& airspaces);
+	size_t size() const { return m_airspaces.size(); };
+	const Airspace& at(size_t id) const { return m_airspaces[id]; };
+	void find(double lat, double lon, int pressAlt, int gnssAlt, std::vector<size_t>& result) const;
+	void check(const FlightTrack& track, std::vector<AirspaceInfringement>& result) const;
+};
+
+bool AirspaceIndex::isInsidePolygon(const std::vector<Edge>& edges, double lat, double lon)
+{
+	bool inside = false;
+	for (auto& edge : edges) {
+		if ((edge.m_lat1 > lat) != (edge.m_lat2 > lat)) {
+			double crossLong = edge.m_long1 + (lat - edge.m_lat1) * (edge.m_long2 - edge.m_long1) / (edge.m_lat2 - edge.m_lat1);
+			if (lon < crossLong) {
+				inside = !inside;
+			}
+		}
+	}
+	return inside;
+}
+
+// True if the edge crosses the line from (lat1, lon1) to (lat2, lon2).
+bool AirspaceIndex::crosses(const Edge& edge, double lat1, double lon1, double lat2, double lon2)
+{
+	auto side = [](double ax, double ay, double bx, double by, double cx, double cy) {
+		return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+	};
+	double d1 = side(edge.m_long1, edge.m_lat1, edge.m_long2, edge.m_lat2, lon1, lat1);
+	double d2 = side(edge.m_long1, edge.m_lat1, edge.m_long2, edge.m_lat2, lon2, lat2);
+	double d3 = side(lon1, lat1, lon2, lat2, edge.m_long1, edge.m_lat1);
+	double d4 = side(lon1, lat1, lon2, lat2, edge.m_long2, edge.m_lat2);
+	return ((d1 > 0) != (d2 > 0)) && ((d3 > 0) != (d4 > 0));
+}
+
+void AirspaceIndex::compile(const std::vector<Airspace>& airspaces)
+{
+	m_airspaces.clear();
+	for (auto& airspace : airspaces) {
+		if (airspace.isValid()) {
+			m_airspaces.push_back(airspace);
+		}
+	}
+	m_circles.assign(m_airspaces.size(), Circle());
+	m_entries.clear();
+	m_edges.clear();
+	m_cellOffsets.clear();
+	if (m_airspaces.empty()) {
+		m_rows = m_columns = 0;
+		return;
+	}
+
+	// Edges and bounding box of every airspace
+	std::vector<std::vector<Edge>> edges(m_airspaces.size());
+	std::vector<std::array<double, 4>> boxes(m_airspaces.size());	// min lat, min long, max lat, max long
+	for (size_t a = 0; a < m_airspaces.size(); a++) {
+		const Airspace& airspace = m_airspaces[a];
+		std::array<double, 4>& box = boxes[a];
+		if (airspace.isCircle()) {
+			Circle& circle = m_circles[a];
+			circle.m_lat = airspace.getCenterLatitude();
+			circle.m_long = airspace.getCenterLongitude();
+			circle.m_cosLat = cos(toRadians(circle.m_lat));
+			double radius = airspace.getRadius() / METERS_PER_DEGREE;
+			circle.m_radius2 = radius * radius;
+			box = { circle.m_lat - radius, circle.m_long - radius / circle.m_cosLat, circle.m_lat + radius, circle.m_long + radius / circle.m_cosLat };
+			continue;
+		}
+		auto& points = airspace.getPoints();
+		box = { points[0].first, points[0].second, points[0].first, points[0].second };
+		for (size_t i = 0; i < points.size(); i++) {
+			auto& from = points[i];
+			auto& to = points[(i + 1) % points.size()];
+			edges[a].push_back({ from.first, from.second, to.first, to.second });
+			box[0] = std::min(box[0], from.first);
+			box[1] = std::min(box[1], from.second);
+			box[2] = std::max(box[2], from.first);
+			box[3] = std::max(box[3], from.second);
+		}
+	}
+
+	// Grid over all airspaces, at most about a million cells
+	std::array<double, 4> bounds = boxes[0];
+	for (auto& box : boxes) {
+		bounds[0] = std::min(bounds[0], box[0]);
+		bounds[1] = std::min(bounds[1], box[1]);
+		bounds[2] = std::max(bounds[2], box[2]);
+		bounds[3] = std::max(bounds[3], box[3]);
+	}
+	m_cellSize = 0.05;
+	while (((bounds[2] - bounds[0]) / m_cellSize + 1) * ((bounds[3] - bounds[1]) / m_cellSize + 1) > 1000000.0) {
+		m_cellSize *= 2;
+	}
+	m_minLat = bounds[0];
+	m_minLong = bounds[1];
+	m_rows = (int)((bounds[2] - bounds[0]) / m_cellSize) + 1;
+	m_columns = (int)((bounds[3] - bounds[1]) / m_cellSize) + 1;
+
+	std::vector<std::vector<Entry>> cells((size_t)m_rows * m_columns);
+	std::vector<std::vector<Edge>> entryEdges;
+	for (size_t a = 0; a < m_airspaces.size(); a++) {
+		const std::array<double, 4>& box = boxes[a];
+		int row1 = std::max(0, (int)((box[0] - m_minLat) / m_cellSize));
+		int column1 = std::max(0, (int)((box[1] - m_minLong) / m_cellSize));
+		int row2 = std::min(m_rows - 1, (int)((box[2] - m_minLat) / m_cellSize));
+		int column2 = std::min(m_columns - 1, (int)((box[3] - m_minLong) / m_cellSize));
+		int columns = column2 - column1 + 1;
+
+		// Edges by cell, an edge is added to every cell of its bounding box
+		std::vector<std::vector<Edge>> boxEdges((size_t)(row2 - row1 + 1) * columns);
+		for (auto& edge : edges[a]) {
+			int r1 = std::max(row1, (int)((std::min(edge.m_lat1, edge.m_lat2) - m_minLat) / m_cellSize));
+			int r2 = std::min(row2, (int)((std::max(edge.m_lat1, edge.m_lat2) - m_minLat) / m_cellSize));
+			int c1 = std::max(column1, (int)((std::min(edge.m_long1, edge.m_long2) - m_minLong) / m_cellSize));
+			int c2 = std::min(column2, (int)((std::max(edge.m_long1, edge.m_long2) - m_minLong) / m_cellSize));
+			for (int r = r1; r <= r2; r++) {
+				for (int c = c1; c <= c2; c++) {
+					boxEdges[(size_t)(r - row1) * columns + (c - column1)].push_back(edge);
+				}
+			}
+		}
+		for (int r = row1; r <= row2; r++) {
+			for (int c = column1; c <= column2; c++) {
+				double lat1 = m_minLat + r * m_cellSize;
+				double lon1 = m_minLong + c * m_cellSize;
+				double centerLat = lat1 + m_cellSize / 2;
+				double centerLong = lon1 + m_cellSize / 2;
+				Entry entry = { (uint32_t)a, EntryType::Inside, true, 0, 0 };
+				if (m_airspaces[a].isCircle()) {
+					const Circle& circle = m_circles[a];
+					double nearLat = std::max(lat1, std::min(circle.m_lat, lat1 + m_cellSize)) - circle.m_lat;
+					double nearLong = (std::max(lon1, std::min(circle.m_long, lon1 + m_cellSize)) - circle.m_long) * circle.m_cosLat;
+					if (nearLat * nearLat + nearLong * nearLong > circle.m_radius2) {
+						continue;
+					}
+					double farLat = std::max(std::abs(lat1 - circle.m_lat), std::abs(lat1 + m_cellSize - circle.m_lat));
+					double farLong = std::max(std::abs(lon1 - circle.m_long), std::abs(lon1 + m_cellSize - circle.m_long)) * circle.m_cosLat;
+					if (farLat * farLat + farLong * farLong > circle.m_radius2) {
+						entry.m_type = EntryType::Circle;
+					}
+				}
+				else {
+					std::vector<Edge>& cellEdges = boxEdges[(size_t)(r - row1) * columns + (c - column1)];
+					bool centerInside = isInsidePolygon(edges[a], centerLat, centerLong);
+					if (cellEdges.empty()) {
+						if (centerInside == false) {
+							continue;
+						}
+					}
+					else {
+						entry.m_type = EntryType::Polygon;
+						entry.m_centerInside = centerInside;
+						entry.m_firstEdge = (uint32_t)m_edges.size();
+						entry.m_edgeCount = (uint32_t)cellEdges.size();
+						m_edges.insert(m_edges.end(), cellEdges.begin(), cellEdges.end());
+					}
+				}
+				cells[(size_t)r * m_columns + c].push_back(entry);
+			}
+		}
+	}
+
+	m_cellOffsets.reserve(cells.size() + 1);
+	m_cellOffsets.push_back(0);
+	for (auto& cell : cells) {
+		m_entries.insert(m_entries.end(), cell.begin(), cell.end());
+		m_cellOffsets.push_back((uint32_t)m_entries.size());
+	}
+}
+
+bool AirspaceIndex::isInsideLateral(const Entry& entry, double lat, double lon, int row, int column) const
+{
+	switch (entry.m_type) {
+	case EntryType::Inside:
+		return true;
+	case EntryType::Circle:
+	{
+		const Circle& circle = m_circles[entry.m_airspace];
+		double dLat = lat - circle.m_lat;
+		double dLong = (lon - circle.m_long) * circle.m_cosLat;
+		return (dLat * dLat + dLong * dLong) <= circle.m_radius2;
+	}
+	case EntryType::Polygon:
+	{
+		double centerLat = m_minLat + (row + 0.5) * m_cellSize;
+		double centerLong = m_minLong + (column + 0.5) * m_cellSize;
+		bool inside = entry.m_centerInside;
+		for (uint32_t i = entry.m_firstEdge; i < entry.m_firstEdge + entry.m_edgeCount; i++) {
+			if (crosses(m_edges[i], centerLat, centerLong, lat, lon)) {
+				inside = !inside;
+			}
+		}
+		return inside;
+	}
+	}
+	return false;
+}
+
+// Adds the airspaces containing the position to the result.
+void AirspaceIndex::find(double lat, double lon, int pressAlt, int gnssAlt, std::vector<size_t>& result) const
+{
+	if (m_rows == 0 || lat < m_minLat || lon < m_minLong) {
+		return;
+	}
+	int row = (int)((lat - m_minLat) / m_cellSize);
+	int column = (int)((lon - m_minLong) / m_cellSize);
+	if (row >= m_rows || column >= m_columns) {
+		return;
+	}
+	size_t cell = (size_t)row * m_columns + column;
+	for (uint32_t i = m_cellOffsets[cell]; i < m_cellOffsets[cell + 1]; i++) {
+		const Entry& entry = m_entries[i];
+		if (m_airspaces[entry.m_airspace].isInsideVertical(pressAlt, gnssAlt) && isInsideLateral(entry, lat, lon, row, column)) {
+			result.push_back(entry.m_airspace);
+		}
+	}
+}
+
+// Adds one infringement for every continuous run of fixes inside an airspace.
+void AirspaceIndex::check(const FlightTrack& track, std::vector<AirspaceInfringement>& result) const
+{
+	std::vector<size_t> open(m_airspaces.size(), SIZE_MAX);	// Last infringement by airspace
+	std::vector<size_t> found;
+	for (size_t i = 0; i < track.size(); i++) {
+		found.clear();
+		find(track.getLatitude(i), track.getLongitude(i), track.getPressAlt(i), track.getGNSSAlt(i), found);
+		for (auto airspace : found) {
+			size_t last = open[airspace];
+			if (last != SIZE_MAX && result[last].m_lastFix + 1 == i) {
+				result[last].m_lastFix = i;
+				result[last].m_endTime = track.getTime(i);
+				continue;
+			}
+			AirspaceInfringement infringement;
+			infringement.m_airspace = airspace;
+			infringement.m_firstFix = infringement.m_lastFix = i;
+			infringement.m_startTime = infringement.m_endTime = track.getTime(i);
+			open[airspace] = result.size();
+			result.push_back(infringement);
+		}
+	}
+}
+
+
+/*
+Logbook store
+
+An embedded on-disk logbook, one row per flight with the header fields and the FlightSummary metrics.
+The file is append-only. Records are buffered until flush() or close(), a crash loses the
+flights added since the last flush, and a record only partly written is removed on open:
+
+	"IGCLOG1\n"					File identification
+	'I' id						Random store id, ties the index file to this store
+	'S' length text				String, the strings get the ids 0, 1, 2... in file order
+	'F' LogbookRow				Flight, the strings of the row are written before it
+
+Strings (file, pilot, glider, site) are interned, a row only holds their ids. The whole file is
+read on open. The secondary indexes on pilot, glider, site and date are sorted arrays of
+(key, date, row), so a query is a binary search for the key and date range followed by a scan
+of the matching rows only. The sorted indexes are saved to an index file on close and read back
+on open (see Index file below); rows added since are sorted and merged into the indexes at the
+next query.
+*/
+struct LogbookEntry {
+	std::string m_file;
+	std::string m_pilot;
+	std::string m_glider;
+	std::string m_site;				// Take-off position from FlightSummary
+	uint32_t m_date{ 0 };			// YYYYMMDD
+	int m_duration{ 0 };			// seconds
+	int m_maxDistance{ 0 };			// meters
+	int m_trackLength{ 0 };			// meters
+	int m_maxAltitude{ 0 };			// meters
+	int m_altitudeGain{ 0 };		// meters
+};
+
+struct LogbookQuery {
+	std::string m_pilot;			// Empty for any
+	std::string m_glider;
+	std::string m_site;
+	uint32_t m_fromDate{ 0 };		// YYYYMMDD, inclusive
+	uint32_t m_toDate{ 99991231 };
+	int m_minDuration{ 0 };			// seconds
+	int m_minDistance{ 0 };			// meters
+};
+
+enum class LogbookGroup {
+	Pilot,
+	Glider,
+	Site,
+	Year
+};
+
+struct LogbookGroupResult {
+	std::string m_key;
+	int m_numberOfFlights{ 0 };
+	int64_t m_duration{ 0 };		// seconds
+	int64_t m_trackLength{ 0 };		// meters
+};
+
+class LogbookStore {
+	struct LogbookRow {
+		uint32_t m_file;
+		uint32_t m_pilot;
+		uint32_t m_glider;
+		uint32_t m_site;
+		uint32_t m_date;
+		int32_t m_duration;
+		int32_t m_maxDistance;
+		int32_t m_trackLength;
+		int32_t m_maxAltitude;
+		int32_t m_altitudeGain;
+	};
+	struct IndexEntry {
+		uint32_t m_key;
+		uint32_t m_date;
+		uint32_t m_row;
+		bool operator<(const IndexEntry& other) const {
+			if (m_key != other.m_key) {
+				return m_key < other.m_key;
+			}
+			if (m_date != other.m_date) {
+				return m_date < other.m_date;
+			}
+			return m_row < other.m_row;
+		}
+	};
+	struct Index {
+		std::vector<IndexEntry> m_entries;
+		size_t m_sorted{ 0 };
+	};
+	struct IndexFileHeader {
+		char m_magic[8];
+		uint64_t m_storeId;
+		uint64_t m_fileSize;			// Log bytes covered
+		uint32_t m_numberOfRows;
+		uint32_t m_numberOfStrings;
+	};
+	static constexpr const char* Magic = "IGCLOG1\n";
+	static constexpr const char* IndexMagic = "IGCIDX2\n";
+	static constexpr uint32_t NoString = UINT32_MAX;
+
+	std::string m_path;
+	std::ofstream m_file;
+	uint64_t m_fileSize{ 0 };					// Bytes of complete records in the file
+	uint64_t m_storeId{ 0 };
+	std::string m_stringData;					// The strings one after the other
+	std::vector<uint64_t> m_stringOffsets{ 0 };	// String id is m_stringOffsets[id] to m_stringOffsets[id + 1]
+	std::vector<uint32_t> m_stringOrder;		// String ids sorted by text, then the ids added since
+	size_t m_sortedStrings{ 0 };
+	std::unordered_map<std::string, uint32_t> m_stringIds;	// The strings not sorted yet
+	std::vector<LogbookRow> m_rows;
+	uint32_t m_indexFileRows{ 0 };				// Rows and strings in the index file
+	uint32_t m_indexFileStrings{ 0 };
+	Index m_pilotIndex;
+	Index m_gliderIndex;
+	Index m_siteIndex;
+	Index m_dateIndex;
+
+	uint32_t numberOfStrings() const { return (uint32_t)(m_stringOffsets.size() - 1); };
+	std::string_view getString(uint32_t id) const;
+	void addString(const char* text, uint32_t length);
+	uint32_t intern(const std::string& text);
+	uint32_t findString(const std::string& text) const;
+	void sortStrings();
+	void insertRow(uint32_t id);
+	bool readIndexFile(std::ifstream& file, const IndexFileHeader& header);
+	void writeIndexFile();
+	void writeStoreId();
+	static void sortIndex(Index& index);
+	static std::pair<const IndexEntry*, const IndexEntry*> range(const Index& index, uint32_t key, uint32_t fromDate, uint32_t toDate);
+public:
+	LogbookStore() = default;
+	~LogbookStore();
+	bool open(const char* path);
+	void close();
+	void flush();
+	bool add(const LogbookEntry& entry);
+	bool add(const char* file, const FlightRecord& flightRecord, const FlightSummary& summary);
+	size_t size() const { return m_rows.size(); };
+	LogbookEntry at(uint32_t row) const;
+	std::vector<uint32_t> query(const LogbookQuery& query);
+	std::vector<LogbookGroupResult> group(const LogbookQuery& query, LogbookGroup group);
+};
+
+LogbookStore::~LogbookStore()
+{
+	close();
+}
+
+// Opens the store, creating the file if it does not exist.
+bool LogbookStore::open(const char* path)
+{
+	close();
+	m_path = path;
+	size_t magicLength = strlen(Magic);
+	std::vector<char> data;
+	if (Utils::FileExists(path)) {
+		std::ifstream file(path, std::ios::binary);
+		if (file.is_open() == false) {
+			return false;
+		}
+		std::error_code error;
+		data.resize((size_t)std::filesystem::file_size(path, error));
+		file.read(data.data(), data.size());
+		data.resize((size_t)file.gcount());
+		if (data.size() < magicLength && (data.empty() || memcmp(data.data(), Magic, data.size()) == 0)) {
+			data.clear();	// Crashed while the store was created, create it again
+		}
+		else if (data.size() < magicLength || memcmp(data.data(), Magic, magicLength) != 0) {
+			return false;
+		}
+	}
+	// The index file is only used if it ends on a record boundary of this file
+	std::ifstream indexFile(m_path + ".idx", std::ios::binary);
+	IndexFileHeader header{};
+	if (indexFile.read((char*)&header, sizeof(header)).good() == false || memcmp(header.m_magic, IndexMagic, sizeof(header.m_magic)) != 0) {
+		header = IndexFileHeader{};
+	}
+	size_t indexedRows = SIZE_MAX;
+	size_t indexedStrings = SIZE_MAX;
+	size_t pos = magicLength;
+	while (pos < data.size()) {
+		if (pos == header.m_fileSize) {
+			indexedRows = m_rows.size();
+			indexedStrings = numberOfStrings();
+		}
+		if (data[pos] == 'S' && pos + 5 <= data.size()) {
+			uint32_t length;
+			memcpy(&length, &data[pos + 1], sizeof(length));
+			if (pos + 5 + length > data.size()) {
+				break;
+			}
+			addString(&data[pos + 5], length);
+			pos += 5 + length;
+		}
+		else if (data[pos] == 'F' && pos + 1 + sizeof(LogbookRow) <= data.size()) {
+			LogbookRow row;
+			memcpy(&row, &data[pos + 1], sizeof(row));
+			m_rows.push_back(row);
+			pos += 1 + sizeof(LogbookRow);
+		}
+		else if (data[pos] == 'I' && pos + 1 + sizeof(m_storeId) <= data.size()) {
+			memcpy(&m_storeId, &data[pos + 1], sizeof(m_storeId));
+			pos += 1 + sizeof(m_storeId);
+		}
+		else {
+			break;
+		}
+	}
+	if (pos == header.m_fileSize) {
+		indexedRows = m_rows.size();
+		indexedStrings = numberOfStrings();
+	}
+	if (m_storeId != 0 && header.m_storeId == m_storeId &&
+		indexedRows == header.m_numberOfRows && indexedStrings == header.m_numberOfStrings && readIndexFile(indexFile, header)) {
+		m_indexFileRows = header.m_numberOfRows;
+		m_indexFileStrings = header.m_numberOfStrings;
+	}
+	else {
+		m_stringOrder.resize(numberOfStrings());
+		for (uint32_t id = 0; id < m_stringOrder.size(); id++) {
+			m_stringOrder[id] = id;
+		}
+		sortStrings();
+	}
+	for (uint32_t id = (uint32_t)m_sortedStrings; id < numberOfStrings(); id++) {
+		m_stringOrder.push_back(id);
+		m_stringIds.emplace(getString(id), id);
+	}
+	for (uint32_t id = m_indexFileRows; id < m_rows.size(); id++) {
+		insertRow(id);
+	}
+	if (data.empty()) {
+		pos = 0;
+	}
+	if (pos < data.size() || (data.empty() && Utils::FileExists(path))) {
+		// Last record was not written completely
+		std::error_code error;
+		std::filesystem::resize_file(path, pos, error);
+		if (error) {
+			return false;
+		}
+	}
+	m_file.open(path, std::ios::binary | std::ios::app);
+	if (m_file.is_open() == false) {
+		return false;
+	}
+	m_fileSize = pos;
+	if (data.empty()) {
+		// Written at once, so a new store is never left without its identification
+		m_file.write(Magic, magicLength);
+		m_fileSize = magicLength;
+		writeStoreId();
+	}
+	else if (m_storeId == 0) {
+		writeStoreId();	// Store created before store ids
+	}
+	return true;
+}
+
+// Writes the index file if flights were added or it was out of date.
+void LogbookStore::close()
+{
+	if (m_file.is_open()) {
+		if (m_rows.size() != m_indexFileRows || numberOfStrings() != m_indexFileStrings) {
+			writeIndexFile();
+		}
+		m_file.close();
+	}
+	m_fileSize = 0;
+	m_storeId = 0;
+	m_stringData.clear();
+	m_stringOffsets.assign(1, 0);
+	m_stringOrder.clear();
+	m_sortedStrings = 0;
+	m_stringIds.clear();
+	m_rows.clear();
+	m_indexFileRows = 0;
+	m_indexFileStrings = 0;
+	m_pilotIndex = Index();
+	m_gliderIndex = Index();
+	m_siteIndex = Index();
+	m_dateIndex = Index();
+}
+
+// Writes the buffered records to the file.
+void LogbookStore::flush()
+{
+	m_file.flush();
+}
+
+/*
+Index file
+
+<store>.idx holds the sorted string ids and indexes of the first rows of the store, so open
+reads them instead of sorting. It is written to <store>.idx.tmp and renamed, so it is either
+complete or the previous one. It is ignored unless it has the store id of the store and ends on
+a record boundary of it with the same number of rows and strings, so the index file of a deleted
+and recreated store is not used. The rows after it are sorted at the first query.
+
+	IndexFileHeader					"IGCIDX2\n", store id, store bytes, rows, strings
+	uint32_t[strings]				String ids sorted by text
+	IndexEntry[rows]				Pilot index
+	IndexEntry[rows]				Glider index
+	IndexEntry[rows]				Site index
+	IndexEntry[rows]				Date index
+*/
+bool LogbookStore::readIndexFile(std::ifstream& file, const IndexFileHeader& header)
+{
+	m_stringOrder.resize(header.m_numberOfStrings);
+	file.read((char*)m_stringOrder.data(), m_stringOrder.size() * sizeof(uint32_t));
+	for (Index* index : { &m_pilotIndex, &m_gliderIndex, &m_siteIndex, &m_dateIndex }) {
+		index->m_entries.resize(header.m_numberOfRows);
+		file.read((char*)index->m_entries.data(), index->m_entries.size() * sizeof(IndexEntry));
+		index->m_sorted = index->m_entries.size();
+	}
+	if (file.good() == false) {
+		m_stringOrder.clear();
+		m_pilotIndex = Index();
+		m_gliderIndex = Index();
+		m_siteIndex = Index();
+		m_dateIndex = Index();
+		return false;
+	}
+	m_sortedStrings = m_stringOrder.size();
+	return true;
+}
+
+void LogbookStore::writeIndexFile()
+{
+	m_file.flush();
+	if (m_file.good() == false) {
+		return;
+	}
+	sortStrings();
+	sortIndex(m_pilotIndex);
+	sortIndex(m_gliderIndex);
+	sortIndex(m_siteIndex);
+	sortIndex(m_dateIndex);
+	std::string path = m_path + ".idx";
+	std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+	IndexFileHeader header{};
+	memcpy(header.m_magic, IndexMagic, sizeof(header.m_magic));
+	header.m_storeId = m_storeId;
+	header.m_fileSize = m_fileSize;
+	header.m_numberOfRows = (uint32_t)m_rows.size();
+	header.m_numberOfStrings = numberOfStrings();
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)m_stringOrder.data(), m_stringOrder.size() * sizeof(uint32_t));
+	for (Index* index : { &m_pilotIndex, &m_gliderIndex, &m_siteIndex, &m_dateIndex }) {
+		file.write((const char*)index->m_entries.data(), index->m_entries.size() * sizeof(IndexEntry));
+	}
+	file.close();
+	std::error_code error;
+	if (file.fail() == false) {
+		std::filesystem::rename(tempPath, path, error);
+	}
+	if (file.fail() || error) {
+		std::filesystem::remove(tempPath, error);
+	}
+}
+
+// Writes a new random store id and flushes it.
+void LogbookStore::writeStoreId()
+{
+	std::random_device device;
+	uint64_t now = (uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+	m_storeId = ((((uint64_t)device()) << 32) | device()) ^ now;
+	if (m_storeId == 0) {
+		m_storeId = 1;
+	}
+	m_file.put('I');
+	m_file.write((const char*)&m_storeId, sizeof(m_storeId));
+	m_file.flush();
+	m_fileSize += 1 + sizeof(m_storeId);
+}
+
+std::string_view LogbookStore::getString(uint32_t id) const
+{
+	return std::string_view(m_stringData.data() + m_stringOffsets[id], (size_t)(m_stringOffsets[id + 1] - m_stringOffsets[id]));
+}
+
+void LogbookStore::addString(const char* text, uint32_t length)
+{
+	m_stringData.append(text, length);
+	m_stringOffsets.push_back(m_stringData.size());
+}
+
+// Returns the id of the string, writing it to the file if it is new.
+uint32_t LogbookStore::intern(const std::string& text)
+{
+	uint32_t id = findString(text);
+	if (id != NoString) {
+		return id;
+	}
+	id = numberOfStrings();
+	addString(text.data(), (uint32_t)text.length());
+	m_stringOrder.push_back(id);
+	m_stringIds.emplace(text, id);
+	if (m_file.is_open()) {
+		uint32_t length = (uint32_t)text.length();
+		m_file.put('S');
+		m_file.write((const char*)&length, sizeof(length));
+		m_file.write(text.data(), length);
+		m_fileSize += 5 + length;
+	}
+	return id;
+}
+
+// Binary search of the sorted strings, then the strings added since.
+uint32_t LogbookStore::findString(const std::string& text) const
+{
+	auto end = m_stringOrder.begin() + m_sortedStrings;
+	auto item = std::lower_bound(m_stringOrder.begin(), end, text, [this](uint32_t id, const std::string& text) {
+		return getString(id) < text;
+	});
+	if (item != end && getString(*item) == text) {
+		return *item;
+	}
+	auto added = m_stringIds.find(text);
+	return (added != m_stringIds.end()) ? added->second : NoString;
+}
+
+// Sorts the string ids added since the last sort and merges them into the sorted part.
+void LogbookStore::sortStrings()
+{
+	if (m_sortedStrings == m_stringOrder.size()) {
+		return;
+	}
+	auto less = [this](uint32_t a, uint32_t b) {
+		return getString(a) < getString(b);
+	};
+	auto middle = m_stringOrder.begin() + m_sortedStrings;
+	std::sort(middle, m_stringOrder.end(), less);
+	std::inplace_merge(m_stringOrder.begin(), middle, m_stringOrder.end(), less);
+	m_sortedStrings = m_stringOrder.size();
+	m_stringIds.clear();
+}
+
+void LogbookStore::insertRow(uint32_t id)
+{
+	const LogbookRow& row = m_rows[id];
+	m_pilotIndex.m_entries.push_back({ row.m_pilot, row.m_date, id });
+	m_gliderIndex.m_entries.push_back({ row.m_glider, row.m_date, id });
+	m_siteIndex.m_entries.push_back({ row.m_site, row.m_date, id });
+	m_dateIndex.m_entries.push_back({ 0, row.m_date, id });
+}
+
+// Returns false if the file is already in the logbook. Files are stored by canonical path,
+// so ./a.igc and /tmp/a.igc are the same file.
+bool LogbookStore::add(const LogbookEntry& entry)
+{
+	std::error_code error;
+	std::string file = std::filesystem::weakly_canonical(entry.m_file, error).string();
+	if (error || file.empty()) {
+		file = entry.m_file;
+	}
+	uint32_t id = findString(file);
+	if (id != NoString) {
+		for (const LogbookRow& row : m_rows) {
+			if (row.m_file == id) {
+				return false;
+			}
+		}
+	}
+	LogbookRow row;
+	row.m_file = intern(file);
+	row.m_pilot = intern(entry.m_pilot);
+	row.m_glider = intern(entry.m_glider);
+	row.m_site = intern(entry.m_site);
+	row.m_date = entry.m_date;
+	row.m_duration = entry.m_duration;
+	row.m_maxDistance = entry.m_maxDistance;
+	row.m_trackLength = entry.m_trackLength;
+	row.m_maxAltitude = entry.m_maxAltitude;
+	row.m_altitudeGain = entry.m_altitudeGain;
+	if (m_file.is_open()) {
+		m_file.put('F');
+		m_file.write((const char*)&row, sizeof(row));
+		m_fileSize += 1 + sizeof(row);
+	}
+	m_rows.push_back(row);
+	insertRow((uint32_t)(m_rows.size() - 1));
+	return true;
+}
+
+bool LogbookStore::add(const char* file, const FlightRecord& flightRecord, const FlightSummary& summary)
+{
+	LogbookEntry entry;
+	entry.m_file = file;
+	entry.m_pilot = flightRecord.getHRecord()->getPilot();
+	entry.m_glider = flightRecord.getHRecord()->getGliderModel();
+	entry.m_site = summary.getLocation();
+	entry.m_date = flightRecord.getHRecord()->getDate();
+	entry.m_duration = summary.getDuration();
+	entry.m_maxDistance = (int)std::lround(summary.getMaxDistance());
+	entry.m_trackLength = (int)std::lround(summary.getTrackLength());
+	entry.m_maxAltitude = summary.getMaxAltitude();
+	entry.m_altitudeGain = summary.getAltitudeGain();
+	return add(entry);
+}
+
+LogbookEntry LogbookStore::at(uint32_t row) const
+{
+	const LogbookRow& item = m_rows[row];
+	LogbookEntry entry;
+	entry.m_file = getString(item.m_file);
+	entry.m_pilot = getString(item.m_pilot);
+	entry.m_glider = getString(item.m_glider);
+	entry.m_site = getString(item.m_site);
+	entry.m_date = item.m_date;
+	entry.m_duration = item.m_duration;
+	entry.m_maxDistance = item.m_maxDistance;
+	entry.m_trackLength = item.m_trackLength;
+	entry.m_maxAltitude = item.m_maxAltitude;
+	entry.m_altitudeGain = item.m_altitudeGain;
+	return entry;
+}
+
+// Sorts the entries added since the last sort and merges them into the sorted part.
+void LogbookStore::sortIndex(Index& index)
+{
+	if (index.m_sorted == index.m_entries.size()) {
+		return;
+	}
+	auto middle = index.m_entries.begin() + index.m_sorted;
+	std::sort(middle, index.m_entries.end());
+	std::inplace_merge(index.m_entries.begin(), middle, index.m_entries.end());
+	index.m_sorted = index.m_entries.size();
+}
+
+std::pair<const LogbookStore::IndexEntry*, const LogbookStore::IndexEntry*> LogbookStore::range(const Index& index, uint32_t key, uint32_t fromDate, uint32_t toDate)
+{
+	const IndexEntry* begin = index.m_entries.data();
+	const IndexEntry* end = begin + index.m_entries.size();
+	IndexEntry from = { key, fromDate, 0 };
+	IndexEntry to = { key, toDate, UINT32_MAX };
+	return std::make_pair(std::lower_bound(begin, end, from), std::upper_bound(begin, end, to));
+}
+
+// Returns the rows matching the query in date order. Uses the index with the fewest rows for the query.
+std::vector<uint32_t> LogbookStore::query(const LogbookQuery& query)
+{
+	std::vector<uint32_t> result;
+	uint32_t pilot = (query.m_pilot.empty()) ? NoString : findString(query.m_pilot);
+	uint32_t glider = (query.m_glider.empty()) ? NoString : findString(query.m_glider);
+	uint32_t site = (query.m_site.empty()) ? NoString : findString(query.m_site);
+	if ((query.m_pilot.empty() == false && pilot == NoString) ||
+		(query.m_glider.empty() == false && glider == NoString) ||
+		(query.m_site.empty() == false && site == NoString)) {
+		return result;
+	}
+	sortIndex(m_dateIndex);
+	auto best = range(m_dateIndex, 0, query.m_fromDate, query.m_toDate);
+	auto narrow = [&](Index& index, uint32_t key) {
+		if (key == NoString) {
+			return;
+		}
+		sortIndex(index);
+		auto candidate = range(index, key, query.m_fromDate, query.m_toDate);
+		if (candidate.second - candidate.first < best.second - best.first) {
+			best = candidate;
+		}
+	};
+	narrow(m_pilotIndex, pilot);
+	narrow(m_gliderIndex, glider);
+	narrow(m_siteIndex, site);
+
+	for (const IndexEntry* entry = best.first; entry < best.second; entry++) {
+		const LogbookRow& row = m_rows[entry->m_row];
+		if ((pilot != NoString && row.m_pilot != pilot) ||
+			(glider != NoString && row.m_glider != glider) ||
+			(site != NoString && row.m_site != site) ||
+			row.m_date < query.m_fromDate || row.m_date > query.m_toDate ||
+			row.m_duration < query.m_minDuration ||
+			row.m_maxDistance < query.m_minDistance) {
+			continue;
+		}
+		result.push_back(entry->m_row);
+	}
+	return result;
+}
+
+// Totals of the rows matching the query, by pilot, glider, site or year.
+std::vector<LogbookGroupResult> LogbookStore::group(const LogbookQuery& query, LogbookGroup group)
+{
+	std::unordered_map<uint32_t, LogbookGroupResult> groups;
+	for (auto id : LogbookStore::query(query)) {
+		const LogbookRow& row = m_rows[id];
+		uint32_t key = 0;
+		switch (group) {
+		case LogbookGroup::Pilot:
+			key = row.m_pilot;
+			break;
+		case LogbookGroup::Glider:
+			key = row.m_glider;
+			break;
+		case LogbookGroup::Site:
+			key = row.m_site;
+			break;
+		case LogbookGroup::Year:
+			key = row.m_date / 10000;
+			break;
+		}
+		LogbookGroupResult& item = groups[key];
+		item.m_numberOfFlights++;
+		item.m_duration += row.m_duration;
+		item.m_trackLength += row.m_trackLength;
+	}
+	std::vector<LogbookGroupResult> result;
+	result.reserve(groups.size());
+	for (auto& item : groups) {
+		item.second.m_key = (group == LogbookGroup::Year) ? std::to_string(item.first) : std::string(getString(item.first));
+		result.push_back(item.second);
+	}
+	std::sort(result.begin(), result.end(), [](const LogbookGroupResult& a, const LogbookGroupResult& b) {
+		return a.m_key < b.m_key;
+	});
+	return result;
+}
+
+/*
+IGCReader -dup file1.igc file2.igc ...
+Prints the groups of duplicate and flew together flights.
+*/
+int findDuplicates(int argc, char* argv[])
+{
+	std::vector<std::string> paths;
+	FlightIndex index;
+	for (int i = 2; i < argc; i++) {
+		if (Utils::FileExists(argv[i]) == false) {
+			printf("File not found: %s\n", argv[i]);
+			continue;
+		}
+		IGCFile IGCFile;
+		FlightRecord flightRecord;
+		if (IGCFile.read(argv[i], flightRecord) == false) {
+			printf("Cannot read: %s\n", argv[i]);
+			continue;
+		}
+		FlightFingerprint fingerprint;
+		fingerprint.compute(flightRecord);
+		index.insert(fingerprint);
+		paths.push_back(argv[i]);
+	}
+	printf("Duplicates\n");
+	for (auto& group : index.groups(FlightMatch::NearDuplicate)) {
+		for (auto id : group) {
+			printf("  %s", paths[id].c_str());
+		}
+		printf("\n");
+	}
+	printf("Flew together\n");
+	for (auto& group : index.groups(FlightMatch::FlewTogether)) {
+		for (auto id : group) {
+			printf("  %s", paths[id].c_str());
+		}
+		printf("\n");
+	}
+	return 0;
+}
+
+/*
+IGCReader -replay step file1.igc file2.igc ...
+Replays the flights together and prints the leader at every step.
+*/
+int replay(int argc, char* argv[])
+{
+	if (argc < 4) {
+		return -1;
+	}
+	int step = atoi(argv[2]);
+	std::vector<std::string> paths;
+	FlightReplay flightReplay;
+	for (int i = 3; i < argc; i++) {
+		IGCFile IGCFile;
+		FlightRecord flightRecord;
+		FlightTrack track;
+		if (Utils::FileExists(argv[i]) == false || IGCFile.read(argv[i], flightRecord) == false || track.load(flightRecord) == false) {
+			printf("Cannot read: %s\n", argv[i]);
+			continue;
+		}
+		flightReplay.addTrack(std::move(track));
+		paths.push_back(argv[i]);
+	}
+	if (flightReplay.start(step) == false) {
+		return -1;
+	}
+	do {
+		int time = flightReplay.getTime() % (24 * 3600);
+		int active = 0;
+		for (auto& position : flightReplay.getPositions()) {
+			if (position.m_active) {
+				active++;
+			}
+		}
+		if (flightReplay.getLeader() == SIZE_MAX) {
+			printf("Time: %02d%02d%02d  Active: 0\n", time / 3600, (time / 60) % 60, time % 60);
+			continue;
+		}
+		const ReplayPosition& leader = flightReplay.getPositions()[flightReplay.getLeader()];
+		printf("Time: %02d%02d%02d  Active: %d  Leader: %s  Distance: %.0f\n", time / 3600, (time / 60) % 60, time % 60,
+			active, paths[flightReplay.getLeader()].c_str(), leader.m_distance);
+	} while (flightReplay.next());
+	return 0;
+}
+
+/*
+IGCReader -airspace airspace.txt file1.igc file2.igc ...
+Checks the flights against an OpenAir airspace file and prints the infringements.
+*/
+int checkAirspace(int argc, char* argv[])
+{
+	if (argc < 4) {
+		return -1;
+	}
+	OpenAirFile openAirFile;
+	std::vector<Airspace> airspaces;
+	if (Utils::FileExists(argv[2]) == false || openAirFile.read(argv[2], airspaces) == false) {
+		printf("Cannot read: %s\n", argv[2]);
+		return -1;
+	}
+	AirspaceIndex index;
+	index.compile(airspaces);
+	printf("Airspaces: %zu\n", index.size());
+	std::vector<AirspaceInfringement> infringements;
+	for (int i = 3; i < argc; i++) {
+		IGCFile IGCFile;
+		FlightRecord flightRecord;
+		FlightTrack track;
+		if (Utils::FileExists(argv[i]) == false || IGCFile.read(argv[i], flightRecord) == false || track.load(flightRecord) == false) {
+			printf("Cannot read: %s\n", argv[i]);
+			continue;
+		}
+		infringements.clear();
+		index.check(track, infringements);
+		printf("File: %s  Infringements: %zu\n", argv[i], infringements.size());
+		for (auto& item : infringements) {
+			const Airspace& airspace = index.at(item.m_airspace);
+			int start = item.m_startTime % (24 * 3600);
+			int end = item.m_endTime % (24 * 3600);
+			printf("  %s %s  From: %02d%02d%02d  To: %02d%02d%02d\n", airspace.getClass().c_str(), airspace.getName().c_str(),
+				start / 3600, (start / 60) % 60, start % 60, end / 3600, (end / 60) % 60, end % 60);
+		}
+	}
+	return 0;
+}
+
+/*
+IGCReader -tail seconds file1.igc file2.igc ...
+Follows IGC files still being written and prints the summary of each flight when it grows.
+*/
+int tail(int argc, char* argv[])
+{
+	if (argc < 4) {
+		return -1;
+	}
+	int seconds = std::max(1, atoi(argv[2]));
+	std::vector<std::shared_ptr<IGCTail>> tails;
+	for (int i = 3; i < argc; i++) {
+		tails.push_back(std::make_shared<IGCTail>(argv[i]));
+	}
+	for (;;) {
+		for (auto item : tails) {
+			if (item->update() <= 0) {
+				continue;
+			}
+			const FlightSummary& summary = item->getSummary();
+			int duration = summary.getDuration();
+			printf("File: %s  Fixes: %zu  Duration: %02d:%02d:%02d  Track: %.1f km  Max Altitude: %d m\n", item->getPath().c_str(),
+				summary.getNumberOfFixes(), duration / 3600, (duration / 60) % 60, duration % 60, summary.getTrackLength() / 1000.0, summary.getMaxAltitude());
+		}
+		fflush(stdout);
+		std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	}
+	return 0;
+}
+
+/*
+IGCReader -logbook store.db add file1.igc file2.igc ...
+IGCReader -logbook store.db query [pilot=NAME] [glider=NAME] [site=NAME] [from=YYYYMMDD] [to=YYYYMMDD] [hours=N] [km=N]
+IGCReader -logbook store.db group pilot|glider|site|year [filters as for query]
+*/
+int logbook(int argc, char* argv[])
+{
+	if (argc < 4) {
+		return -1;
+	}
+	LogbookStore store;
+	if (store.open(argv[2]) == false) {
+		printf("Cannot open: %s\n", argv[2]);
+		return -1;
+	}
+	std::string command = argv[3];
+	if (command.compare("add") == 0) {
+		for (int i = 4; i < argc; i++) {
+			IGCFile IGCFile;
+			FlightRecord flightRecord;
+			FlightSummary summary;
+			if (Utils::FileExists(argv[i]) == false || IGCFile.read(argv[i], flightRecord) == false) {
+				printf("Cannot read: %s\n", argv[i]);
+				continue;
+			}
+			summary.update(flightRecord);
+			if (store.add(argv[i], flightRecord, summary) == false) {
+				printf("Already in logbook: %s\n", argv[i]);
+				continue;
+			}
+			store.flush();	// Keep the flights read so far if a later file crashes the reader
+		}
+		printf("Flights: %zu\n", store.size());
+		return 0;
+	}
+	int first = 4;
+	LogbookGroup group = LogbookGroup::Year;
+	if (command.compare("group") == 0) {
+		if (argc < 5) {
+			return -1;
+		}
+		std::string by = argv[4];
+		group = (by.compare("pilot") == 0) ? LogbookGroup::Pilot : (by.compare("glider") == 0) ? LogbookGroup::Glider :
+			(by.compare("site") == 0) ? LogbookGroup::Site : LogbookGroup::Year;
+		first = 5;
+	}
+	else if (command.compare("query") != 0) {
+		return -1;
+	}
+	LogbookQuery query;
+	for (int i = first; i < argc; i++) {
+		std::string filter = argv[i];
+		size_t equals = filter.find('=');
+		if (equals == std::string::npos) {
+			continue;
+		}
+		std::string name = filter.substr(0, equals);
+		std::string value = filter.substr(equals + 1);
+		if (name.compare("pilot") == 0) { query.m_pilot = value; }
+		if (name.compare("glider") == 0) { query.m_glider = value; }
+		if (name.compare("site") == 0) { query.m_site = value; }
+		if (name.compare("from") == 0) { query.m_fromDate = (uint32_t)atol(value.c_str()); }
+		if (name.compare("to") == 0) { query.m_toDate = (uint32_t)atol(value.c_str()); }
+		if (name.compare("hours") == 0) { query.m_minDuration = (int)(atof(value.c_str()) * 3600); }
+		if (name.compare("km") == 0) { query.m_minDistance = (int)(atof(value.c_str()) * 1000); }
+	}
+	if (command.compare("group") == 0) {
+		for (auto& item : store.group(query, group)) {
+			printf("%s  Flights: %d  Hours: %.1f  Km: %.1f\n", item.m_key.c_str(), item.m_numberOfFlights,
+				item.m_duration / 3600.0, item.m_trackLength / 1000.0);
+		}
+		return 0;
+	}
+	for (auto id : store.query(query)) {
+		LogbookEntry entry = store.at(id);
+		printf("%u  %s  %s  %s  %02d:%02d  %.1f km  %s\n", entry.m_date, entry.m_pilot.c_str(), entry.m_glider.c_str(), entry.m_site.c_str(),
+			entry.m_duration / 3600, (entry.m_duration / 60) % 60, entry.m_trackLength / 1000.0, entry.m_file.c_str());
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	double dist = calcGPSDistance(51.55069, 001.55616, 51.55068, 001.55616);
+	printf("Dist %f\n", dist);
+
+	if (argc < 2) {
+		return -1;
+	}
+	if (argv[1] == nullptr) {
+		return -1;
+	}
+	if (std::string(argv[1]).compare("-dup") == 0) {
+		return findDuplicates(argc, argv);
+	}
+	if (std::string(argv[1]).compare("-replay") == 0) {
+		return replay(argc, argv);
+	}
+	if (std::string(argv[1]).compare("-airspace") == 0) {
+		return checkAirspace(argc, argv);
+	}
+	if (std::string(argv[1]).compare("-tail") == 0) {
+		return tail(argc, argv);
+	}
+	if (std::string(argv[1]).compare("-logbook") == 0) {
+		return logbook(argc, argv);
+	}
 	if (Utils::FileExists(argv[1]) == false) {
 		return -1;
 	}